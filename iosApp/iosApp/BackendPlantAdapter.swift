@@ -19,29 +19,48 @@ final class BackendPlantAdapter: ObservableObject {
     private let dashboardViewModel: DashboardViewModel
     private var cancellables = Set<AnyCancellable>()
 
+    // Plants whose photo is being read, so each is only requested once
+    private var imageLoadsInFlight: Set<UUID> = []
+
     init() {
         dashboardViewModel = HelperKt.getDashboardViewModel()
 
-        let publisher: AnyPublisher<[Shared.Plant], Error> =
-            createPublisher(for: dashboardViewModel.plantsStateFlow)
+        let publisher: AnyPublisher<ListUpdate<Shared.Plant>, Error> =
+            createPublisher(for: dashboardViewModel.plantUpdates)
 
         publisher
             .receive(on: DispatchQueue.main)
             .sink(
                 receiveCompletion: { completion in
                     if case let .failure(error) = completion {
-                        print("❌ Error observing plantsStateFlow:", error)
+                        print("❌ Error observing plantUpdates:", error)
                     }
                 },
-                receiveValue: { [weak self] (plants: [Shared.Plant]) in
+                receiveValue: { [weak self] (update: ListUpdate<Shared.Plant>) in
                     guard let self = self else { return }
-                    self.backendPlants = plants
-
+                    self.apply(update: update)
                 }
             )
             .store(in: &cancellables)
     }
 
+    /// Patch changed rows in place when only contents changed, otherwise take the new list.
+    private func apply(update: ListUpdate<Shared.Plant>) {
+        let items = update.items as [Shared.Plant]
+        let delta = update.delta
+        if delta.isEmpty {
+            return
+        }
+        if delta.isUpdateOnly && items.count == backendPlants.count {
+            for index in delta.updated {
+                let row = index.intValue
+                backendPlants[row] = items[row]
+            }
+        } else {
+            backendPlants = items
+        }
+    }
+
     /// Persist a SwiftUI Plant to the backend.
     func save(uiPlant: Plant) {
         let backend = createBackendPlantFromUI(uiPlant: uiPlant)
@@ -90,7 +109,7 @@ final class BackendPlantAdapter: ObservableObject {
         }
 
         // 5. Pass everything to HelperKt
-        return HelperKt.createBackendPlant(
+        let backend = HelperKt.createBackendPlant(
             idString: uiPlant.id.uuidString,
             name: uiPlant.name,
             species: uiPlant.species,
@@ -103,6 +122,15 @@ final class BackendPlantAdapter: ObservableObject {
             imageBytes: kotlinImageBytes,
             notes: uiPlant.notes
         )
+
+        // 6. Cards only hold the thumbnail, keep the stored photo unless a new one was picked
+        if uiPlant.imageData == nil {
+            let uuidString = uiPlant.id.uuidString.lowercased()
+            backend.image = backendPlants.first(where: {
+                $0.uuid.description.lowercased() == uuidString
+            })?.image
+        }
+        return backend
     }
 
     /// Fetch and update image for an existing plant from Perenual API
@@ -133,6 +161,53 @@ final class BackendPlantAdapter: ObservableObject {
         }
     }
 
+    /// Reads a plant photo at the given size from the backend without blocking the main thread.
+    /// Lists pass .thumbnail, only a view showing the photo large needs .full.
+    /// Returns nil if the plant has no photo or it is already being loaded.
+    func loadImageData(for backend: Shared.Plant, size: ImageSize) async -> Data? {
+        guard backend.image != nil,
+              let uuid = UUID(uuidString: backend.uuid.description),
+              !imageLoadsInFlight.contains(uuid) else {
+            return nil
+        }
+        imageLoadsInFlight.insert(uuid)
+        defer { imageLoadsInFlight.remove(uuid) }
+
+        do {
+            let kotlinBytes: KotlinByteArray? = try await asyncFunction(
+                for: dashboardViewModel.loadPlantImage(plant: backend, size: size)
+            )
+            guard let kotlinBytes = kotlinBytes else { return nil }
+            let count = Int(kotlinBytes.size)
+            var bytes = [UInt8](repeating: 0, count: count)
+            for index in 0..<count {
+                bytes[index] = UInt8(bitPattern: kotlinBytes.get(index: Int32(index)))
+            }
+            return Data(bytes)
+        } catch {
+            print("❌ Error loading plant image:", error)
+            return nil
+        }
+    }
+
+    /// Tells the reminders that a task was just done, so its next reminder is a full period away.
+    func markDone(uiPlant: Plant, task: PlantTask) {
+        let careTask: CareTask
+        switch task.title {
+        case "water": careTask = .water
+        case "fertilize": careTask = .fertilize
+        case "trimming": careTask = .trim
+        default: return
+        }
+
+        let uuidString = uiPlant.id.uuidString.lowercased()
+        if let backend = backendPlants.first(where: {
+            $0.uuid.description.lowercased() == uuidString
+        }) {
+            dashboardViewModel.markCareDone(plant: backend, task: careTask)
+        }
+    }
+
     func delete(uiPlant: Plant) {
         // FIX: Add to pending deletions BEFORE calling backend delete
         pendingDeletionIDs.insert(uiPlant.id)
@@ -191,23 +266,12 @@ func convertBackendPlant(_ backend: Shared.Plant) -> Plant {
     let trimDays = Int(trimMillis / oneDayMillis)
     let trimTask = PlantTask(title: "trimming", reminderEnabled: trimEnabled, frequencyDays: trimDays, timesPerDay: 0, waterMode: .everyXDays)
 
-    // --- 4. Convert Kotlin ByteArray to Swift Data ---
-    var imageData: Data?
-    if let plantImage = backend.image,
-       let kotlinBytes = plantImage.imageBytes {
-        let count = Int(kotlinBytes.size)
-        var bytes = [UInt8](repeating: 0, count: count)
-        for index in 0..<count {
-            bytes[index] = UInt8(bitPattern: kotlinBytes.get(index: Int32(index)))
-        }
-        imageData = Data(bytes)
-    }
-
+    // --- 4. The thumbnail is read later by BackendPlantAdapter.loadImageData ---
     return Plant(
         id: UUID(uuidString: backend.uuid.description) ?? UUID(),
         name: backend.name,
         species: backend.species,
-        imageData: imageData,
+        imageData: nil,
         notes: backend.notes,
         tasks: [waterTask, fertTask, trimTask]
     )
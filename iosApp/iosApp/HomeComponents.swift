@@ -180,13 +180,20 @@ struct PlantCardWrapper: View {
     let plant: Plant
     let onUpdate: (Plant) -> Void
     let onDelete: (UUID) -> Void
+    let onMarkDone: (PlantTask) -> Void
 
     @State private var localPlant: Plant
 
-    init(plant: Plant, onUpdate: @escaping (Plant) -> Void, onDelete: @escaping (UUID) -> Void) {
+    init(
+        plant: Plant,
+        onUpdate: @escaping (Plant) -> Void,
+        onDelete: @escaping (UUID) -> Void,
+        onMarkDone: @escaping (PlantTask) -> Void = { _ in }
+    ) {
         self.plant = plant
         self.onUpdate = onUpdate
         self.onDelete = onDelete
+        self.onMarkDone = onMarkDone
         self._localPlant = State(initialValue: plant)
     }
 
@@ -196,7 +203,8 @@ struct PlantCardWrapper: View {
             onSave: { updated in
                 onUpdate(updated)
             },
-            onDelete: onDelete
+            onDelete: onDelete,
+            onMarkDone: onMarkDone
         )
         .onChange(of: plant) { newPlant in
             // Sync if parent data changes (e.g., image updated from backend)
@@ -593,6 +601,8 @@ struct PlantCard: View {
 
     var onDelete: (UUID) -> Void = { _ in }
 
+    var onMarkDone: (PlantTask) -> Void = { _ in }
+
     @State private var showReminders = false
     @State private var isEditing = false
 
@@ -639,6 +649,7 @@ struct PlantCard: View {
     private struct ReminderRow: View {
         @Binding var task: PlantTask
         let plant: Plant
+        var onDone: () -> Void = {}
         @State private var showNotifDeniedAlert = false
 
         var body: some View {
@@ -652,6 +663,16 @@ struct PlantCard: View {
                     subLabel
                 }
                 Spacer()
+                if task.reminderEnabled {
+                    // Restarts the reminders of this task from now
+                    Button(action: onDone) {
+                        Image(systemName: "checkmark.circle")
+                            .font(.system(size: 22, weight: .semibold))
+                            .foregroundColor(Color("DarkGreen"))
+                    }
+                    .buttonStyle(.plain)
+                    .accessibilityLabel("Mark \(task.title) done")
+                }
                 Toggle("", isOn: $task.reminderEnabled)
                     .labelsHidden()
                     .onChange(of: task.reminderEnabled) { isOn in
@@ -687,59 +708,30 @@ struct PlantCard: View {
                 .eraseToAnyView()
         }
 
+        // Only asks for permission, reminders are scheduled by the shared
+        // ReminderScheduler once the plant is saved with the task enabled
         private func handleToggle(isOn: Bool) {
-            let id = "\(plant.id.uuidString)::\(task.title.lowercased())"
-
-            if isOn {
-                NotificationManager.currentStatus { status in
-                    switch status {
-                    case .notDetermined:
-                        NotificationManager.requestAuthorization { granted in
-                            if granted {
-                                scheduleCurrentReminder(identifier: id)
-                            } else {
-                                task.reminderEnabled = false
-                                showNotifDeniedAlert = true
-                            }
+            guard isOn else { return }
+
+            NotificationManager.currentStatus { status in
+                switch status {
+                case .notDetermined:
+                    NotificationManager.requestAuthorization { granted in
+                        if !granted {
+                            task.reminderEnabled = false
+                            showNotifDeniedAlert = true
                         }
-                    case .denied:
-                        task.reminderEnabled = false
-                        showNotifDeniedAlert = true
-                    case .authorized, .provisional, .ephemeral:
-                        scheduleCurrentReminder(identifier: id)
-                    @unknown default:
-                        task.reminderEnabled = false
                     }
+                case .denied:
+                    task.reminderEnabled = false
+                    showNotifDeniedAlert = true
+                case .authorized, .provisional, .ephemeral:
+                    break
+                @unknown default:
+                    task.reminderEnabled = false
                 }
-            } else {
-                NotificationManager.cancel(identifier: id)
             }
         }
-
-        private func scheduleCurrentReminder(identifier: String) {
-            let title = task.title.lowercased()
-            let seconds: TimeInterval
-
-            if title == "water" {
-                if task.waterMode == .timesPerDay {
-                    let timesPerDay = max(task.timesPerDay, 1)
-                    seconds = TimeInterval((24 * 60 * 60) / timesPerDay)
-                } else {
-                    let days = max(task.frequencyDays, 1)
-                    seconds = TimeInterval(days * 24 * 60 * 60)
-                }
-            } else {
-                let days = max(task.frequencyDays, 1)
-                seconds = TimeInterval(days * 24 * 60 * 60)
-            }
-
-            NotificationManager.scheduleRepeating(
-                taskTitle: task.title,
-                plantName: plant.name.isEmpty ? "your plant" : plant.name,
-                identifier: identifier,
-                intervalSeconds: seconds
-            )
-        }
     }
 
     // ===============================================================
@@ -775,7 +767,7 @@ struct PlantCard: View {
                 Spacer(minLength: 0)
             }
 
-            if let data = plant.imageData,
+            if let data = plant.imageData ?? plant.thumbnailData,
                let uiImage = UIImage(data: data) {
                 Image(uiImage: uiImage)
                     .resizable()
@@ -833,7 +825,7 @@ struct PlantCard: View {
                 .background(Color("DarkGreen").opacity(0.15))
 
             ForEach($plant.tasks) { $task in
-                ReminderRow(task: $task, plant: plant)
+                ReminderRow(task: $task, plant: plant, onDone: { onMarkDone(task) })
                     .padding(.vertical, 4)
             }
 
@@ -1245,7 +1237,7 @@ struct EditPlantSheet: View {
                                         Image(uiImage: uiImage)
                                             .resizable()
                                             .scaledToFill()
-                                    } else if let data = plant.imageData, let uiImage = UIImage(data: data) {
+                                    } else if let data = plant.imageData ?? plant.thumbnailData, let uiImage = UIImage(data: data) {
                                         Image(uiImage: uiImage)
                                             .resizable()
                                             .scaledToFill()
@@ -1351,9 +1343,6 @@ struct EditPlantSheet: View {
                                             }
                                         }
                                         .pickerStyle(.segmented)
-                                        .onChange(of: task.waterMode) { _ in
-                                            rescheduleIfNeeded(task: task)
-                                        }
 
                                         if task.waterMode == .timesPerDay {
                                             HStack {
@@ -1368,9 +1357,6 @@ struct EditPlantSheet: View {
                                             .font(.caption)
                                             .foregroundColor(.secondary)
                                             .padding(.leading, 4)
-                                            .onChange(of: task.timesPerDay) { _ in
-                                                rescheduleIfNeeded(task: task)
-                                            }
 
                                         } else {
                                             HStack {
@@ -1385,9 +1371,6 @@ struct EditPlantSheet: View {
                                             .font(.caption)
                                             .foregroundColor(.secondary)
                                             .padding(.leading, 4)
-                                            .onChange(of: task.frequencyDays) { _ in
-                                                rescheduleIfNeeded(task: task)
-                                            }
                                         }
 
                                     } else {
@@ -1403,9 +1386,6 @@ struct EditPlantSheet: View {
                                         .font(.caption)
                                         .foregroundColor(.secondary)
                                         .padding(.leading, 4)
-                                        .onChange(of: task.frequencyDays) { _ in
-                                            rescheduleIfNeeded(task: task)
-                                        }
                                     }
 
                                 }
@@ -1521,32 +1501,6 @@ struct EditPlantSheet: View {
             newNotes = plant.notes
         }
     }
-    private func rescheduleIfNeeded(task: PlantTask) {
-        guard task.reminderEnabled else { return }
-
-        let identifier = "\(plant.id.uuidString)::\(task.title.lowercased())"
-        let seconds: TimeInterval
-
-        if task.title.lowercased() == "water" {
-            if task.waterMode == .timesPerDay {
-                let timesPerDay = max(task.timesPerDay, 1)
-                seconds = TimeInterval((24 * 60 * 60) / timesPerDay)
-            } else {
-                let days = max(task.frequencyDays, 1)
-                seconds = TimeInterval(days * 24 * 60 * 60)
-            }
-        } else {
-            let days = max(task.frequencyDays, 1)
-            seconds = TimeInterval(days * 24 * 60 * 60)
-        }
-
-        NotificationManager.scheduleRepeating(
-            taskTitle: task.title,
-            plantName: plant.name.isEmpty ? "your plant" : plant.name,
-            identifier: identifier,
-            intervalSeconds: seconds
-        )
-    }
 
 }
 
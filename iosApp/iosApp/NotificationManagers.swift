@@ -16,26 +16,14 @@ enum NotificationManager {
             DispatchQueue.main.async { completion(granted) }
         }
     }
-    static func scheduleRepeating(taskTitle: String,
-                                  plantName: String,
-                                  identifier: String,
-                                  intervalSeconds: TimeInterval) {
-        UNUserNotificationCenter.current()
-            .removePendingNotificationRequests(withIdentifiers: [identifier])
-
-        let content = UNMutableNotificationContent()
-        content.title = "Time to \(taskTitle.capitalized)"
-        content.body  = "Don’t forget to \(taskTitle) your \(plantName) 🌿"
-        content.sound = .default
-
-        let seconds = max(60, intervalSeconds)
-        let trigger = UNTimeIntervalNotificationTrigger(timeInterval: seconds, repeats: true)
-
-        UNUserNotificationCenter.current()
-            .add(UNNotificationRequest(identifier: identifier, content: content, trigger: trigger))
-    }
-    static func cancel(identifier: String) {
-        UNUserNotificationCenter.current().removePendingNotificationRequests(withIdentifiers: [identifier])
+    /// Removes the repeating per-task reminders older versions scheduled,
+    /// the shared ReminderScheduler replaces them with digests
+    static func removeLegacyReminders() {
+        let center = UNUserNotificationCenter.current()
+        center.getPendingNotificationRequests { requests in
+            let identifiers = requests.map(\.identifier).filter { $0.contains("::") }
+            center.removePendingNotificationRequests(withIdentifiers: identifiers)
+        }
     }
     static func openSettings() {
         if let url = URL(string: UIApplication.openSettingsURLString) { UIApplication.shared.open(url) }
@@ -33,6 +33,7 @@ struct Plant: Identifiable, Hashable {
     var name: String                    // Display name
     var species: String                 // Plant species (required)
     var imageData: Data?                // Optional user-selected photo
+    var thumbnailData: Data? = nil      // Small copy of the stored photo, for cards
     var notes: String                   // Notes entered by user
     var tasks: [PlantTask]              // List of task reminders for this plant
 }
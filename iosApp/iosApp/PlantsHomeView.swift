@@ -30,7 +30,7 @@ struct PlantsHomeView: View {
             // use the first plant's image as fallback (if it has one)
             return PlantbookEntry(
                 speciesName: name,
-                fallbackImageData: first.imageData
+                fallbackImageData: first.imageData ?? first.thumbnailData
             )
         }
         .sorted { $0.speciesName.localizedCaseInsensitiveCompare($1.speciesName) == .orderedAscending }
@@ -94,6 +94,9 @@ struct PlantsHomeView: View {
                                             withAnimation {
                                                 store.plants.removeAll { $0.id == id }
                                             }
+                                        },
+                                        onMarkDone: { task in
+                                            backendAdapter.markDone(uiPlant: plant, task: task)
                                         }
                                     )
                                 }
@@ -148,18 +151,8 @@ struct PlantsHomeView: View {
                     return nil
                 }
 
-                if var existing = existingMap[uuid] {
-                    // Keep existing plant but update image if backend has one and local doesn't
-                    if existing.imageData == nil,
-                       let plantImage = backendPlant.image,
-                       let kotlinBytes = plantImage.imageBytes {
-                        let count = Int(kotlinBytes.size)
-                        var bytes = [UInt8](repeating: 0, count: count)
-                        for index in 0..<count {
-                            bytes[index] = UInt8(bitPattern: kotlinBytes.get(index: Int32(index)))
-                        }
-                        existing.imageData = Data(bytes)
-                    }
+                if let existing = existingMap[uuid] {
+                    // Keep existing plant, missing photos are loaded below
                     return existing
                 } else {
                     // New plant from backend
@@ -173,13 +166,21 @@ struct PlantsHomeView: View {
 
             if currentIDs != mergedIDs {
                 store.plants = merged
-            } else {
-                // Check for image updates only
-                for (index, plant) in store.plants.enumerated() {
-                    if let mergedPlant = merged.first(where: { $0.id == plant.id }),
-                       plant.imageData == nil && mergedPlant.imageData != nil {
-                        store.plants[index].imageData = mergedPlant.imageData
+            }
+
+            // Load thumbnails the local plants are missing, off the main thread
+            for backendPlant in backendPlants where backendPlant.image != nil {
+                guard let uuid = UUID(uuidString: backendPlant.uuid.description),
+                      store.plants.contains(where: { $0.id == uuid && $0.thumbnailData == nil }) else {
+                    continue
+                }
+                Task {
+                    guard let data = await backendAdapter.loadImageData(for: backendPlant, size: .thumbnail),
+                          let index = store.plants.firstIndex(where: { $0.id == uuid }),
+                          store.plants[index].thumbnailData == nil else {
+                        return
                     }
+                    store.plants[index].thumbnailData = data
                 }
             }
         }
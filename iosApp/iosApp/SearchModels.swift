@@ -47,11 +47,15 @@ class SearchViewModel: ObservableObject {
         self.errorMessage = nil
 
         do {
-            // Call the Kotlin suspend function
-            let result = try await repository.searchRemotePlants(query: trimmed)
-            let kotlinResults = result as? [Shared.PlantInfo] ?? []
+            // Search the local catalog first, only hit the API when nothing matches
+            let local = try await repository.searchPlantInfo(keyWords: trimmed)
+            var kotlinResults = local as? [Shared.PlantInfo] ?? []
+            if kotlinResults.isEmpty {
+                let remote = try await repository.searchRemotePlants(query: trimmed)
+                kotlinResults = remote as? [Shared.PlantInfo] ?? []
+            }
 
-            print("🌿 API Results: \(kotlinResults.count) plants found.")
+            print("🌿 Search Results: \(kotlinResults.count) plants found.")
 
             if let first = kotlinResults.first {
                 print("🔍 First result: \(first.name ?? "nil"), watering=\(first.wateringDescription)")
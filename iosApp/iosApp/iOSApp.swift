@@ -37,12 +37,18 @@ struct IOSApp: App {
     /// Tracks whether a user is logged in across the whole app.
     @StateObject private var authManager = AuthManager()
 
+    /// Tells when the app comes back to the foreground.
+    @Environment(\.scenePhase) private var scenePhase
+
     /// Runs when the app starts. Sets up Firebase and the shared Kotlin code.
     init() {
         FirebaseApp.configure()
 
         // Pass the API key to the Kotlin shared code (Koin).
         HelperKt.doInitKoin(apiKey: AppConfig.perenualAPIKey)
+
+        // Reminders are scheduled by the shared code now
+        NotificationManager.removeLegacyReminders()
     }
 
     var body: some Scene {
@@ -51,5 +57,11 @@ struct IOSApp: App {
             AuthRootView()
                 .environmentObject(authManager)
         }
+        .onChange(of: scenePhase) { phase in
+            // Only a limited number of reminders is registered, queue the next ones
+            if phase == .active {
+                HelperKt.refreshReminders()
+            }
+        }
     }
 }
@@ -25,6 +25,12 @@ dependencyResolutionManagement {
             }
         }
         mavenCentral()
+        // couchbase-lite-java, used by kotbase on the jvm target
+        maven("https://mobile.maven.couchbase.com/maven2/dev/") {
+            mavenContent {
+                includeGroup("com.couchbase.lite")
+            }
+        }
     }
 }
 
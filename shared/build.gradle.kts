@@ -1,3 +1,5 @@
+import groovy.json.JsonOutput
+import groovy.json.JsonSlurper
 import org.jetbrains.kotlin.gradle.dsl.JvmTarget
 import org.jetbrains.kotlin.gradle.targets.native.tasks.KotlinNativeTest
 
@@ -9,6 +11,8 @@ plugins {
     alias(libs.plugins.kotlinx.serialization)
     alias(libs.plugins.composeMultiplatform)
     alias(libs.plugins.composeCompiler)
+    alias(libs.plugins.kotlinx.benchmark)
+    alias(libs.plugins.kotlinAllOpen)
 
 }
 
@@ -25,6 +29,13 @@ kotlin {
 //        }
 //    }
 
+    // Runs the data layer tests and benchmarks on machines without Xcode
+    jvm {
+        compilations.create("benchmark") {
+            associateWith(this@jvm.compilations.getByName("main"))
+        }
+    }
+
     iosArm64 {
         binaries {
             framework {
@@ -77,9 +88,9 @@ kotlin {
             implementation(libs.kotlinx.serialization.json)
             implementation(libs.filekit.core)
             implementation(libs.filekit.dialogs)
+            implementation(libs.kotlinx.datetime)
             api(libs.androidx.lifecycle.viewmodel)
             api(libs.kmp.observableviewmodel.core)
-            implementation(libs.alarmee)
             implementation(libs.bundles.ktor)
 
         }
@@ -88,16 +99,25 @@ kotlin {
             implementation(libs.koin.core)
             implementation(libs.koin.test)
             implementation(libs.androidx.coroutine.test)
-            implementation(libs.moko.permissions.test)
+            implementation(libs.ktor.client.mock)
+        }
+
+        jvmMain.dependencies {
+            implementation(libs.ktor.client.okhttp)
+        }
+        getByName("jvmBenchmark").dependencies {
+            implementation(libs.kotlinx.benchmark.runtime)
         }
 
         iosMain.dependencies {
             implementation(libs.ktor.client.darwin)
+            implementation(libs.alarmee)
             api(libs.kmp.observableviewmodel.core)
 
         }
         iosTest.dependencies {
             implementation(libs.alarmee)
+            implementation(libs.moko.permissions.test)
             api(libs.moko.permissions)
             implementation(libs.moko.permissions.notifications)
             api(libs.moko.permissions.compose)
@@ -117,6 +137,132 @@ tasks.withType<KotlinNativeTest>().configureEach {
     }
 }
 
+allOpen {
+    annotation("org.openjdk.jmh.annotations.State")
+}
+
+benchmark {
+    targets {
+        register("jvmBenchmark")
+    }
+    configurations {
+        named("main") {
+            warmups = 2
+            iterations = 5
+            iterationTime = 1
+            iterationTimeUnit = "s"
+            mode = "avgt"
+            outputTimeUnit = "us"
+            reportFormat = "json"
+            // Reports the bytes allocated per operation next to the time
+            advanced("jvmProfiler", "gc")
+        }
+        // Only the 100 document datasets, for a quick run before pushing
+        register("smoke") {
+            warmups = 1
+            iterations = 3
+            iterationTime = 1
+            iterationTimeUnit = "s"
+            mode = "avgt"
+            outputTimeUnit = "us"
+            reportFormat = "json"
+            param("size", "100")
+        }
+    }
+}
+
+/**
+ * Compares the newest benchmark report of the main configuration with the
+ * committed baseline, or records the report as the new baseline when
+ * [update] is set. Reports of other configurations, such as smoke, are
+ * never read.
+ *
+ * Scores are average times per operation, so a score above its baseline by
+ * more than the baseline's tolerance is a regression and fails the build.
+ * So does a benchmark without a baseline score, and a baseline score the
+ * report has no result for. A report missing benchmarks of the baseline is
+ * not recorded.
+ */
+abstract class BenchmarkBaselineTask : DefaultTask() {
+    @get:Internal
+    abstract val reportsDir: DirectoryProperty
+
+    @get:Internal
+    abstract val baselineFile: RegularFileProperty
+
+    @get:Input
+    abstract val update: Property<Boolean>
+
+    @TaskAction
+    fun compare() {
+        val report = reportsDir.get().asFile.walkTopDown()
+            .filter { it.isFile && it.extension == "json" }
+            .maxByOrNull { it.lastModified() }
+            ?: throw GradleException("No benchmark report in ${reportsDir.get().asFile}, run the benchmark task first")
+
+        val scores = (JsonSlurper().parse(report) as List<*>).associate { entry ->
+            val result = entry as Map<*, *>
+            val params = (result["params"] as? Map<*, *>).orEmpty().entries.joinToString(",") { "${it.key}=${it.value}" }
+            val name = if (params.isEmpty()) "${result["benchmark"]}" else "${result["benchmark"]}[$params]"
+            name to ((result["primaryMetric"] as Map<*, *>)["score"] as Number).toDouble()
+        }
+
+        val file = baselineFile.get().asFile
+        val baseline = JsonSlurper().parse(file) as Map<*, *>
+        val tolerance = (baseline["tolerance"] as Number).toDouble()
+        val expected = (baseline["benchmarks"] as Map<*, *>).entries.associate { (name, score) -> "$name" to (score as Number).toDouble() }
+        val missing = expected.keys - scores.keys
+
+        if (update.get()) {
+            if (missing.isNotEmpty()) {
+                throw GradleException(
+                    "$report has no score for ${missing.size} baseline benchmarks, record a complete run of the benchmark task:\n" +
+                        missing.joinToString("\n"),
+                )
+            }
+            val json = JsonOutput.toJson(mapOf("tolerance" to tolerance, "benchmarks" to scores.toSortedMap()))
+            file.writeText(JsonOutput.prettyPrint(json) + "\n")
+            logger.lifecycle("Recorded ${scores.size} scores from $report")
+            return
+        }
+
+        val unrecorded = scores.filterKeys { it !in expected }
+        if (unrecorded.isNotEmpty() || missing.isNotEmpty()) {
+            throw GradleException(
+                "Benchmarks and ${file.name} differ, run updateBenchmarkBaseline after an intended change:\n" +
+                    (unrecorded.map { (name, score) -> "$name: $score, no baseline" } + missing.map { "$it: not in $report" })
+                        .joinToString("\n"),
+            )
+        }
+        val regressions = scores.mapNotNull { (name, score) ->
+            val reference = expected.getValue(name)
+            if (score > reference * (1 + tolerance)) "$name: $score, baseline $reference" else null
+        }
+        if (regressions.isNotEmpty()) {
+            throw GradleException(
+                "Benchmarks slower than the baseline by more than ${tolerance * 100}%:\n" + regressions.joinToString("\n"),
+            )
+        }
+    }
+}
+
+tasks.register<BenchmarkBaselineTask>("checkBenchmarkBaseline") {
+    group = "verification"
+    description = "Runs the benchmarks and fails if any of them regressed past benchmarks/baseline.json"
+    dependsOn("benchmark")
+    reportsDir.set(layout.buildDirectory.dir("reports/benchmarks/main"))
+    baselineFile.set(layout.projectDirectory.file("benchmarks/baseline.json"))
+    update.set(false)
+}
+
+tasks.register<BenchmarkBaselineTask>("updateBenchmarkBaseline") {
+    group = "verification"
+    description = "Records the newest report of the benchmark task as benchmarks/baseline.json"
+    reportsDir.set(layout.buildDirectory.dir("reports/benchmarks/main"))
+    baselineFile.set(layout.projectDirectory.file("benchmarks/baseline.json"))
+    update.set(true)
+}
+
 spotless {
     kotlin {
         target("src/**/*.kt")
@@ -1,26 +1,11 @@
 package com.gmg.growmygarden
 
-import com.tweener.alarmee.configuration.AlarmeePlatformConfiguration
-import com.tweener.alarmee.createAlarmeeService
-import com.tweener.alarmee.model.Alarmee
-import com.tweener.alarmee.model.AndroidNotificationConfiguration
-import com.tweener.alarmee.model.AndroidNotificationPriority
-import com.tweener.alarmee.model.IosNotificationConfiguration
-import com.tweener.alarmee.model.RepeatInterval
 import kotlinx.datetime.LocalDateTime
-import kotlin.time.Duration.Companion.minutes
 
 /**
- * Class that handles the creation and deletion of notifications
- * Uses the Alarmee library
+ * Handles the creation and deletion of notifications
  */
-class NotificationHandler {
-    private val alarmeeService = createAlarmeeService().apply {
-        initialize(createAlarmeePlatformConfiguration())
-    }
-
-    private val localService = alarmeeService.local
-
+interface NotificationHandler {
     /**
      * Creates a notification:
      * id: ID number of notification
@@ -30,41 +15,26 @@ class NotificationHandler {
      * image (optional): Image of notification
      * delay: delay between notifications
      */
-    fun setNotification(id: String, title: String, body: String, date: LocalDateTime, image: String?, delay: Long) {
-        localService.schedule(
-            alarmee = Alarmee(
-                uuid = id,
-                notificationTitle = title,
-                notificationBody = body,
-                scheduledDateTime = date,
-                imageUrl = image,
-                repeatInterval = RepeatInterval.Custom(duration = delay.minutes),
-                androidNotificationConfiguration = AndroidNotificationConfiguration(
-                    priority = AndroidNotificationPriority.HIGH,
-                    channelId = "dailyNewsChannelId",
-                ),
-                iosNotificationConfiguration = IosNotificationConfiguration(),
-            ),
-        )
-    }
+    fun setNotification(id: String, title: String, body: String, date: LocalDateTime, image: String?, delay: Long)
+
+    /**
+     * Creates a notification that is shown once at date
+     */
+    fun setOneTimeNotification(id: String, title: String, body: String, date: LocalDateTime)
 
     /**
      * Given an ID of a notification, cancel that notification
      */
-    fun cancelNotification(id: String) {
-        localService.cancel(uuid = id)
-    }
+    fun cancelNotification(id: String)
 
     /**
      * Cancels all set notifications
      */
-    fun cancelAllNotifications() {
-        localService.cancelAll()
-    }
+    fun cancelAllNotifications()
 }
 
 /**
- * Expects a function to be created in iOSMain and androidMain (not used)
- * that configures Alarmee
+ * Expects a function to be created in each platform source set
+ * that returns the platform's [NotificationHandler]
  */
-internal expect fun createAlarmeePlatformConfiguration(): AlarmeePlatformConfiguration
+internal expect fun createNotificationHandler(): NotificationHandler
@@ -1,5 +1,8 @@
 package com.gmg.growmygarden.auth
 
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.StateFlow
+import kotlinx.coroutines.flow.asStateFlow
 import kotlinx.serialization.Serializable
 
 @Serializable
@@ -8,17 +11,22 @@ data class User(
 )
 
 class UserManager {
-    private var _user: User? = null
+    private val _user = MutableStateFlow<User?>(null)
     val user: User?
-        get() = _user
+        get() = _user.value
+
+    /**
+     * The current user, emitting again on every login and logout
+     */
+    val userUpdates: StateFlow<User?> = _user.asStateFlow()
 
     fun login(
         userId: String,
     ) {
-        _user = User(userId)
+        _user.value = User(userId)
     }
 
     fun logout() {
-        _user = null
+        _user.value = null
     }
 }
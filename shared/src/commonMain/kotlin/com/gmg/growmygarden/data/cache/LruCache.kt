@@ -0,0 +1,45 @@
+package com.gmg.growmygarden.data.cache
+
+/**
+ * Least-recently-used map holding at most [maxSize] entries.
+ *
+ * Not synchronized, callers guard it themselves.
+ */
+class LruCache<K : Any, V : Any>(
+    private val maxSize: Int,
+) {
+    private val entries = LinkedHashMap<K, V>()
+
+    val size: Int
+        get() = entries.size
+
+    /**
+     * Returns the value for [key] and marks it as most recently used
+     */
+    operator fun get(key: K): V? {
+        val value = entries.remove(key) ?: return null
+        entries[key] = value
+        return value
+    }
+
+    operator fun set(key: K, value: V) {
+        entries.remove(key)
+        entries[key] = value
+        while (entries.size > maxSize) {
+            entries.remove(entries.keys.first())
+        }
+    }
+
+    fun remove(key: K): V? = entries.remove(key)
+
+    /**
+     * Removes every entry whose value matches [predicate]
+     */
+    fun removeWhere(predicate: (V) -> Boolean) {
+        entries.values.removeAll(predicate)
+    }
+
+    fun clear() {
+        entries.clear()
+    }
+}
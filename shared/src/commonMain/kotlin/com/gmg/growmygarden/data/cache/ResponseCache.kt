@@ -0,0 +1,167 @@
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+@file:OptIn(ExperimentalTime::class)
+
+package com.gmg.growmygarden.data.cache
+
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.db.WriteBehindQueue
+import kotbase.DataSource
+import kotbase.Expression
+import kotbase.Meta
+import kotbase.MutableDocument
+import kotbase.QueryBuilder
+import kotbase.SelectResult
+import kotbase.ktx.from
+import kotbase.ktx.select
+import kotlinx.coroutines.CancellationException
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import kotlinx.coroutines.withContext
+import kotlin.time.Clock
+import kotlin.time.Duration
+import kotlin.time.Duration.Companion.days
+import kotlin.time.ExperimentalTime
+
+/**
+ * Stores raw API responses by request key
+ */
+interface ResponseCache {
+    /**
+     * Returns the body stored for [key] if it is not older than [maxAge]
+     */
+    suspend fun get(key: String, maxAge: Duration): String?
+
+    suspend fun put(key: String, body: String)
+
+    suspend fun clear()
+}
+
+/**
+ * [ResponseCache] persisted in the "apiCache" collection, with the most
+ * recently used responses also kept in memory.
+ *
+ * A response found expired by [get] is purged. Responses older than
+ * [retention] that were never read again are purged when the cache is created.
+ */
+class DatabaseResponseCache(
+    private val dbProvider: DatabaseProvider,
+    private val clock: Clock = Clock.System,
+    private val retention: Duration = DEFAULT_RETENTION,
+) : ResponseCache {
+    private class CachedResponse(val body: String, val storedAt: Long)
+
+    internal val collection by lazy {
+        dbProvider.database.getCollection(COLLECTION_NAME) ?: dbProvider.database.createCollection(COLLECTION_NAME)
+    }
+
+    private val mutex = Mutex()
+    private val memory = LruCache<String, CachedResponse>(MEMORY_CACHE_SIZE)
+
+    private val writeQueue = WriteBehindQueue<String, CachedResponse>(
+        dbProvider = dbProvider,
+        write = { key, response ->
+            collection.save(
+                MutableDocument(key)
+                    .setString(BODY_KEY, response.body)
+                    .setLong(STORED_AT_KEY, response.storedAt),
+            )
+        },
+        purge = { key -> collection.getDocument(key)?.let { doc -> collection.purge(doc) } },
+        onWriteFailed = dbProvider.metrics::recordFailedWrite,
+    )
+
+    override suspend fun get(key: String, maxAge: Duration): String? {
+        val cached = mutex.withLock { memory[key] }
+            ?: load(key)?.let { loaded ->
+                // A response put while loading is newer than the stored one
+                mutex.withLock { memory[key] ?: loaded.also { memory[key] = it } }
+            }
+            ?: return null
+        val age = clock.now().toEpochMilliseconds() - cached.storedAt
+        if (age <= maxAge.inWholeMilliseconds) {
+            return cached.body
+        }
+        mutex.withLock {
+            // Unless a newer response was put in the meantime, its write may still be queued
+            if (memory[key] === cached) {
+                memory.remove(key)
+                writeQueue.remove(key)
+            }
+        }
+        return null
+    }
+
+    override suspend fun put(key: String, body: String) {
+        val response = CachedResponse(body, clock.now().toEpochMilliseconds())
+        mutex.withLock {
+            memory[key] = response
+            writeQueue.put(key, response)
+        }
+    }
+
+    override suspend fun clear() {
+        mutex.withLock { memory.clear() }
+        writeQueue.flush()
+        withContext(dbProvider.writeContext) {
+            (select(Meta.id) from collection).execute().use { results ->
+                results.allResults().forEach { result ->
+                    result.getString(0)?.let { id -> collection.purge(id) }
+                }
+            }
+        }
+    }
+
+    /**
+     * Purges every stored response older than [maxAge]
+     *
+     * @return number of purged responses
+     */
+    internal suspend fun purgeExpired(maxAge: Duration): Int {
+        writeQueue.flush()
+        val cutoff = clock.now().toEpochMilliseconds() - maxAge.inWholeMilliseconds
+        mutex.withLock {
+            memory.removeWhere { response -> response.storedAt < cutoff }
+        }
+        return withContext(dbProvider.writeContext) {
+            val query = QueryBuilder.select(SelectResult.expression(Meta.id))
+                .from(DataSource.collection(collection))
+                .where(Expression.property(STORED_AT_KEY).lessThan(Expression.longValue(cutoff)))
+            val ids = query.execute().use { results -> results.allResults().mapNotNull { result -> result.getString(0) } }
+            dbProvider.database.inBatch {
+                ids.forEach { id -> collection.purge(id) }
+            }
+            ids.size
+        }
+    }
+
+    init {
+        dbProvider.scope.launch {
+            // Whatever is left is purged on the next start
+            try {
+                purgeExpired(retention)
+            } catch (e: CancellationException) {
+                throw e
+            } catch (e: Exception) {
+                dbProvider.metrics.recordFailedWrite(COLLECTION_NAME, e)
+            }
+        }
+    }
+
+    private suspend fun load(key: String): CachedResponse? {
+        return withContext(dbProvider.readContext) {
+            val doc = collection.getDocument(key)
+            doc?.getString(BODY_KEY)?.let { body -> CachedResponse(body, doc.getLong(STORED_AT_KEY)) }
+        }
+    }
+
+    companion object {
+        private const val COLLECTION_NAME = "apiCache"
+        private const val BODY_KEY = "body"
+        private const val STORED_AT_KEY = "storedAt"
+        private const val MEMORY_CACHE_SIZE = 64
+
+        // Longer than the time to live of any response the API caches
+        val DEFAULT_RETENTION = 30.days
+    }
+}
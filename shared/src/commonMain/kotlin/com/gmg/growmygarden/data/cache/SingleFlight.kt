@@ -0,0 +1,53 @@
+package com.gmg.growmygarden.data.cache
+
+import kotlinx.coroutines.CancellationException
+import kotlinx.coroutines.CompletableDeferred
+import kotlinx.coroutines.NonCancellable
+import kotlinx.coroutines.currentCoroutineContext
+import kotlinx.coroutines.ensureActive
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import kotlinx.coroutines.withContext
+
+/**
+ * Coalesces concurrent calls for the same key into one.
+ *
+ * The first caller for a key runs the block, callers arriving while it is
+ * running wait for its result instead of starting their own.
+ */
+class SingleFlight<K : Any, V> {
+    private val mutex = Mutex()
+    private val inFlight = HashMap<K, CompletableDeferred<V>>()
+
+    suspend fun run(key: K, block: suspend () -> V): V {
+        while (true) {
+            var leader = false
+            val deferred = mutex.withLock {
+                inFlight.getOrPut(key) {
+                    leader = true
+                    CompletableDeferred()
+                }
+            }
+
+            if (leader) {
+                try {
+                    return block().also(deferred::complete)
+                } catch (e: Throwable) {
+                    deferred.completeExceptionally(e)
+                    throw e
+                } finally {
+                    withContext(NonCancellable) {
+                        mutex.withLock { inFlight.remove(key) }
+                    }
+                }
+            }
+
+            try {
+                return deferred.await()
+            } catch (e: CancellationException) {
+                // Rethrows if we were cancelled, otherwise the leader was and we try again
+                currentCoroutineContext().ensureActive()
+            }
+        }
+    }
+}
@@ -0,0 +1,137 @@
+@file:OptIn(ExperimentalAtomicApi::class)
+
+package com.gmg.growmygarden.data.db
+
+import kotlin.concurrent.atomics.AtomicLong
+import kotlin.concurrent.atomics.AtomicReference
+import kotlin.concurrent.atomics.ExperimentalAtomicApi
+import kotlin.time.Duration
+import kotlin.time.Duration.Companion.nanoseconds
+import kotlin.time.TimeSource
+
+/**
+ * Counters for the reads and writes done against one [DatabaseProvider].
+ *
+ * Repositories time their queries with [timeQuery] and every
+ * [WriteBehindQueue] reports its batches and pending operations, so the
+ * benchmarks can print where the time went next to their scores. Writes a
+ * queue gave up on are passed to [recordFailedWrite] by their owners.
+ */
+class DatabaseMetrics {
+    /**
+     * Values of every counter at one point in time
+     *
+     * @param queueDepth operations handed to a write queue and not committed yet
+     * @param failedWrites writes dropped after their last attempt
+     * @param lastWriteError error of the most recent dropped write
+     */
+    data class Snapshot(
+        val queries: Long,
+        val queryTime: Duration,
+        val writeBatches: Long,
+        val writtenDocuments: Long,
+        val writeTime: Duration,
+        val queueDepth: Long,
+        val maxQueueDepth: Long,
+        val failedWrites: Long,
+        val lastWriteError: Throwable?,
+    ) {
+        val averageQueryTime: Duration
+            get() = if (queries == 0L) Duration.ZERO else queryTime / queries.toDouble()
+
+        val averageWriteTime: Duration
+            get() = if (writeBatches == 0L) Duration.ZERO else writeTime / writeBatches.toDouble()
+
+        override fun toString(): String {
+            return "queries=$queries (avg $averageQueryTime), " +
+                "writes=$writtenDocuments docs in $writeBatches batches (avg $averageWriteTime), " +
+                "queueDepth=$queueDepth (max $maxQueueDepth), " +
+                "failedWrites=$failedWrites" + (lastWriteError?.let { " (last: $it)" } ?: "")
+        }
+    }
+
+    private val queries = AtomicLong(0)
+    private val queryNanos = AtomicLong(0)
+    private val writeBatches = AtomicLong(0)
+    private val writtenDocuments = AtomicLong(0)
+    private val writeNanos = AtomicLong(0)
+    private val queueDepth = AtomicLong(0)
+    private val maxQueueDepth = AtomicLong(0)
+    private val failedWrites = AtomicLong(0)
+    private val lastWriteError = AtomicReference<Throwable?>(null)
+
+    /**
+     * Runs [block] and counts it as one query
+     */
+    inline fun <T> timeQuery(block: () -> T): T {
+        val mark = TimeSource.Monotonic.markNow()
+        try {
+            return block()
+        } finally {
+            recordQuery(mark.elapsedNow())
+        }
+    }
+
+    fun recordQuery(elapsed: Duration) {
+        queries.incrementAndFetch()
+        queryNanos.addAndFetch(elapsed.inWholeNanoseconds)
+    }
+
+    /**
+     * Counts one committed batch of [documents] writes
+     */
+    fun recordWrite(documents: Int, elapsed: Duration) {
+        writeBatches.incrementAndFetch()
+        writtenDocuments.addAndFetch(documents.toLong())
+        writeNanos.addAndFetch(elapsed.inWholeNanoseconds)
+    }
+
+    /**
+     * Counts one write that [key]'s queue dropped because of [error]
+     */
+    fun recordFailedWrite(key: Any, error: Throwable) {
+        failedWrites.incrementAndFetch()
+        lastWriteError.store(error)
+    }
+
+    fun queued(count: Int = 1) {
+        val depth = queueDepth.addAndFetch(count.toLong())
+        while (true) {
+            val max = maxQueueDepth.load()
+            if (depth <= max || maxQueueDepth.compareAndSet(max, depth)) break
+        }
+    }
+
+    fun committed(count: Int) {
+        queueDepth.addAndFetch(-count.toLong())
+    }
+
+    fun snapshot(): Snapshot {
+        return Snapshot(
+            queries = queries.load(),
+            queryTime = queryNanos.load().nanoseconds,
+            writeBatches = writeBatches.load(),
+            writtenDocuments = writtenDocuments.load(),
+            writeTime = writeNanos.load().nanoseconds,
+            queueDepth = queueDepth.load(),
+            maxQueueDepth = maxQueueDepth.load(),
+            failedWrites = failedWrites.load(),
+            lastWriteError = lastWriteError.load(),
+        )
+    }
+
+    /**
+     * Clears every counter except the current queue depth, which still
+     * tracks operations that are pending
+     */
+    fun reset() {
+        queries.store(0)
+        queryNanos.store(0)
+        writeBatches.store(0)
+        writtenDocuments.store(0)
+        writeNanos.store(0)
+        maxQueueDepth.store(queueDepth.load())
+        failedWrites.store(0)
+        lastWriteError.store(null)
+    }
+}
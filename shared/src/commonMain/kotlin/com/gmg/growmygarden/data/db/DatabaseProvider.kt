@@ -6,18 +6,41 @@ import kotlinx.coroutines.CoroutineName
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.IO
+import kotlinx.coroutines.SupervisorJob
 import kotlin.coroutines.CoroutineContext
 
+/**
+ * Opens the app database and owns the contexts used to read and write it.
+ *
+ * [scope] runs the background work of the repositories, such as the
+ * [WriteBehindQueue] consumers. It is supervised, so one failing job does not
+ * cancel the others.
+ */
 class DatabaseProvider(
     val dispatcher: CoroutineDispatcher = Dispatchers.IO,
     val readContext: CoroutineContext = CoroutineName("db-read") + dispatcher,
     val writeContext: CoroutineContext = CoroutineName("db-write") + dispatcher.limitedParallelism(1),
-    val scope: CoroutineScope = CoroutineScope(writeContext),
+    val scope: CoroutineScope = CoroutineScope(writeContext + SupervisorJob()),
+    val name: String = DB_NAME,
 ) {
+    /**
+     * Query and write counters of this database
+     */
+    val metrics = DatabaseMetrics()
+
     // Linked by Gradle, the IDE will claim an error. We can Ignore it
     @Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
-    val database by lazy { Database(DB_NAME) }
+    val database by lazy {
+        initDatabasePlatform()
+        Database(name)
+    }
     companion object {
         private const val DB_NAME = "grow-my-garden"
     }
 }
+
+/**
+ * Expects a function in each platform source set that prepares
+ * Couchbase Lite before the first database is opened
+ */
+internal expect fun initDatabasePlatform()
@@ -0,0 +1,298 @@
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+@file:OptIn(ExperimentalSerializationApi::class)
+
+package com.gmg.growmygarden.data.db
+
+import kotbase.ArrayInterface
+import kotbase.DictionaryInterface
+import kotbase.MutableDictionaryInterface
+import kotlinx.serialization.DeserializationStrategy
+import kotlinx.serialization.ExperimentalSerializationApi
+import kotlinx.serialization.SerializationException
+import kotlinx.serialization.SerializationStrategy
+import kotlinx.serialization.descriptors.SerialDescriptor
+import kotlinx.serialization.descriptors.StructureKind
+import kotlinx.serialization.encoding.AbstractDecoder
+import kotlinx.serialization.encoding.AbstractEncoder
+import kotlinx.serialization.encoding.CompositeDecoder
+import kotlinx.serialization.encoding.CompositeEncoder
+import kotlinx.serialization.modules.EmptySerializersModule
+import kotlinx.serialization.modules.SerializersModule
+import kotlinx.serialization.serializer
+
+/**
+ * Maps serializable classes to and from kotbase dictionaries without going
+ * through a JSON string.
+ *
+ * Decoding reads only the properties the class declares, so unknown keys and
+ * blobs stored next to them are ignored. Encoding compares every property with
+ * what the dictionary already holds and only sets the ones that differ, so
+ * keys the class does not know about are left untouched.
+ */
+object DocumentCodec {
+    fun <T> decode(deserializer: DeserializationStrategy<T>, dictionary: DictionaryInterface): T {
+        return deserializer.deserialize(ValueDecoder(dictionary))
+    }
+
+    inline fun <reified T> decode(dictionary: DictionaryInterface): T = decode(serializer<T>(), dictionary)
+
+    /**
+     * Writes [value] into [target], skipping properties that already hold
+     * the same value
+     *
+     * @return whether any property was changed
+     */
+    fun <T> encode(serializer: SerializationStrategy<T>, value: T, target: MutableDictionaryInterface): Boolean {
+        var encoded: Any? = null
+        serializer.serialize(ValueEncoder { encoded = it }, value)
+        val properties = encoded as? Map<*, *>
+            ?: throw SerializationException("${serializer.descriptor.serialName} is not encoded as a dictionary")
+
+        var changed = false
+        for ((key, property) in properties) {
+            key as String
+            if (!target.contains(key) || !sameValue(target.getValue(key), property)) {
+                target.setValue(key, property)
+                changed = true
+            }
+        }
+        return changed
+    }
+
+    inline fun <reified T> encode(value: T, target: MutableDictionaryInterface): Boolean = encode(serializer<T>(), value, target)
+
+    private fun sameValue(stored: Any?, value: Any?): Boolean {
+        return when {
+            // Longs above 2^53 lose digits as doubles, so integers compare exactly
+            stored is Number && value is Number -> if (stored.isIntegral() && value.isIntegral()) {
+                stored.toLong() == value.toLong()
+            } else {
+                stored.toDouble() == value.toDouble()
+            }
+            stored is DictionaryInterface -> value is Map<*, *> && stored.count == value.size &&
+                value.all { (key, item) -> sameValue(stored.getValue(key as String), item) }
+            stored is ArrayInterface -> value is List<*> && stored.count == value.size &&
+                value.indices.all { index -> sameValue(stored.getValue(index), value[index]) }
+            else -> stored == value
+        }
+    }
+}
+
+private fun Number.isIntegral(): Boolean = this is Long || this is Int || this is Short || this is Byte
+
+private fun scalar(value: Any): Any = if (value is Char) value.toString() else value
+
+/**
+ * Encodes a value into the types a kotbase dictionary accepts: strings,
+ * numbers, booleans, maps and lists
+ */
+private class ValueEncoder(private val consume: (Any?) -> Unit) : AbstractEncoder() {
+    override val serializersModule: SerializersModule = EmptySerializersModule()
+
+    override fun encodeValue(value: Any) = consume(scalar(value))
+
+    override fun encodeNull() = consume(null)
+
+    override fun encodeEnum(enumDescriptor: SerialDescriptor, index: Int) = consume(enumDescriptor.getElementName(index))
+
+    override fun beginStructure(descriptor: SerialDescriptor): CompositeEncoder {
+        return when (descriptor.kind) {
+            StructureKind.LIST -> ListEncoder(consume)
+            StructureKind.MAP -> MapEncoder(consume)
+            else -> ObjectEncoder(consume)
+        }
+    }
+}
+
+private class ObjectEncoder(private val consume: (Any?) -> Unit) : AbstractEncoder() {
+    override val serializersModule: SerializersModule = EmptySerializersModule()
+
+    private val properties = LinkedHashMap<String, Any?>()
+    private var key = ""
+
+    private fun put(value: Any?) {
+        properties[key] = value
+    }
+
+    override fun encodeElement(descriptor: SerialDescriptor, index: Int): Boolean {
+        key = descriptor.getElementName(index)
+        return true
+    }
+
+    override fun encodeValue(value: Any) = put(scalar(value))
+
+    override fun encodeNull() = put(null)
+
+    override fun encodeEnum(enumDescriptor: SerialDescriptor, index: Int) = put(enumDescriptor.getElementName(index))
+
+    override fun beginStructure(descriptor: SerialDescriptor): CompositeEncoder = ValueEncoder(::put).beginStructure(descriptor)
+
+    override fun endStructure(descriptor: SerialDescriptor) = consume(properties)
+}
+
+private class ListEncoder(private val consume: (Any?) -> Unit) : AbstractEncoder() {
+    override val serializersModule: SerializersModule = EmptySerializersModule()
+
+    private val items = mutableListOf<Any?>()
+
+    override fun encodeValue(value: Any) {
+        items.add(scalar(value))
+    }
+
+    override fun encodeNull() {
+        items.add(null)
+    }
+
+    override fun encodeEnum(enumDescriptor: SerialDescriptor, index: Int) {
+        items.add(enumDescriptor.getElementName(index))
+    }
+
+    override fun beginStructure(descriptor: SerialDescriptor): CompositeEncoder = ValueEncoder(items::add).beginStructure(descriptor)
+
+    override fun endStructure(descriptor: SerialDescriptor) = consume(items)
+}
+
+/**
+ * Maps are written as dictionaries, so keys are stored as strings
+ */
+private class MapEncoder(private val consume: (Any?) -> Unit) : AbstractEncoder() {
+    override val serializersModule: SerializersModule = EmptySerializersModule()
+
+    private val entries = LinkedHashMap<String, Any?>()
+    private var key: String? = null
+
+    private fun put(value: Any?) {
+        val pendingKey = key
+        if (pendingKey == null) {
+            key = value.toString()
+        } else {
+            entries[pendingKey] = value
+            key = null
+        }
+    }
+
+    override fun encodeValue(value: Any) = put(scalar(value))
+
+    override fun encodeNull() = put(null)
+
+    override fun encodeEnum(enumDescriptor: SerialDescriptor, index: Int) = put(enumDescriptor.getElementName(index))
+
+    override fun beginStructure(descriptor: SerialDescriptor): CompositeEncoder = ValueEncoder(::put).beginStructure(descriptor)
+
+    override fun endStructure(descriptor: SerialDescriptor) = consume(entries)
+}
+
+/**
+ * Decodes [value], which is a kotbase dictionary or array, a map or list
+ * read out of one, or a scalar
+ */
+private open class ValueDecoder(protected var value: Any?) : AbstractDecoder() {
+    override val serializersModule: SerializersModule = EmptySerializersModule()
+
+    // Only the root decoder reaches this, structures override it
+    override fun decodeElementIndex(descriptor: SerialDescriptor): Int = CompositeDecoder.DECODE_DONE
+
+    private fun number(): Number = value as? Number
+        ?: throw SerializationException("Expected a number but found $value")
+
+    override fun decodeNotNullMark(): Boolean = value != null
+
+    override fun decodeBoolean(): Boolean = value as? Boolean
+        ?: throw SerializationException("Expected a boolean but found $value")
+
+    override fun decodeByte(): Byte = number().toByte()
+
+    override fun decodeShort(): Short = number().toShort()
+
+    override fun decodeInt(): Int = number().toInt()
+
+    override fun decodeLong(): Long = number().toLong()
+
+    override fun decodeFloat(): Float = number().toFloat()
+
+    override fun decodeDouble(): Double = number().toDouble()
+
+    override fun decodeChar(): Char = decodeString().single()
+
+    override fun decodeString(): String = value as? String
+        ?: throw SerializationException("Expected a string but found $value")
+
+    override fun decodeEnum(enumDescriptor: SerialDescriptor): Int = enumDescriptor.getElementIndex(decodeString())
+
+    override fun beginStructure(descriptor: SerialDescriptor): CompositeDecoder {
+        return when (descriptor.kind) {
+            StructureKind.LIST -> ListDecoder(itemsOf(value))
+            StructureKind.MAP -> MapDecoder(propertiesOf(value))
+            else -> ObjectDecoder(value)
+        }
+    }
+
+    companion object {
+        /**
+         * A scalar where a list is expected is read as a list of one, like
+         * the Perenual fields that are either a string or a list of strings
+         */
+        fun itemsOf(value: Any?): List<Any?> = when (value) {
+            is ArrayInterface -> value.toList()
+            is List<*> -> value
+            else -> listOf(value)
+        }
+
+        @Suppress("UNCHECKED_CAST")
+        fun propertiesOf(value: Any?): Map<String, Any?> = when (value) {
+            is DictionaryInterface -> value.toMap()
+            is Map<*, *> -> value as Map<String, Any?>
+            else -> throw SerializationException("Expected a dictionary but found $value")
+        }
+    }
+}
+
+private class ObjectDecoder(source: Any?) : ValueDecoder(null) {
+    private val dictionary = source as? DictionaryInterface
+    private val properties = if (dictionary == null) propertiesOf(source) else null
+    private var position = 0
+
+    private fun has(key: String) = dictionary?.contains(key) ?: properties!!.containsKey(key)
+
+    private fun get(key: String) = dictionary?.getValue(key) ?: properties?.get(key)
+
+    override fun decodeElementIndex(descriptor: SerialDescriptor): Int {
+        while (position < descriptor.elementsCount) {
+            val index = position++
+            val key = descriptor.getElementName(index)
+            if (!has(key)) continue
+            val property = get(key)
+            // Like missing keys, nulls in non-null properties fall back to the default
+            if (property == null && !descriptor.getElementDescriptor(index).isNullable) continue
+            value = property
+            return index
+        }
+        return CompositeDecoder.DECODE_DONE
+    }
+}
+
+private class ListDecoder(private val items: List<Any?>) : ValueDecoder(null) {
+    private var position = 0
+
+    override fun decodeCollectionSize(descriptor: SerialDescriptor): Int = items.size
+
+    override fun decodeElementIndex(descriptor: SerialDescriptor): Int {
+        if (position >= items.size) return CompositeDecoder.DECODE_DONE
+        value = items[position]
+        return position++
+    }
+}
+
+private class MapDecoder(properties: Map<String, Any?>) : ValueDecoder(null) {
+    private val entries = properties.entries.toList()
+    private var position = 0
+
+    override fun decodeCollectionSize(descriptor: SerialDescriptor): Int = entries.size
+
+    override fun decodeElementIndex(descriptor: SerialDescriptor): Int {
+        if (position >= entries.size * 2) return CompositeDecoder.DECODE_DONE
+        val entry = entries[position / 2]
+        value = if (position % 2 == 0) entry.key else entry.value
+        return position++
+    }
+}
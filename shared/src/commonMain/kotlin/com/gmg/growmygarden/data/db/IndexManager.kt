@@ -0,0 +1,54 @@
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden.data.db
+
+import kotbase.Collection
+import kotbase.Index
+import kotbase.IndexBuilder
+import kotbase.ValueIndexItem
+
+/**
+ * Declares an index on a collection.
+ *
+ * The version is part of the stored index name, so bumping it after changing
+ * [build] replaces the old index on the next startup. Indexes created before
+ * the collection was managed here can be dropped through [replaces].
+ */
+class IndexSpec(
+    val name: String,
+    val version: Int,
+    val replaces: List<String> = emptyList(),
+    val build: () -> Index,
+) {
+    val versionedName: String
+        get() = "${name}_v$version"
+
+    companion object {
+        /**
+         * Value index over the given document properties, in order
+         */
+        fun value(name: String, version: Int, vararg properties: String) = IndexSpec(name, version) {
+            IndexBuilder.valueIndex(*properties.map { ValueIndexItem.property(it) }.toTypedArray())
+        }
+    }
+}
+
+/**
+ * Creates and migrates the indexes declared by the repositories
+ */
+object IndexManager {
+    /**
+     * Creates every missing index in [specs] and deletes older versions of them
+     */
+    fun ensureIndexes(collection: Collection, specs: List<IndexSpec>) {
+        val existing = collection.indexes
+        for (spec in specs) {
+            existing
+                .filter { it != spec.versionedName && (it.startsWith("${spec.name}_v") || it in spec.replaces) }
+                .forEach(collection::deleteIndex)
+            if (spec.versionedName !in existing) {
+                collection.createIndex(spec.versionedName, spec.build())
+            }
+        }
+    }
+}
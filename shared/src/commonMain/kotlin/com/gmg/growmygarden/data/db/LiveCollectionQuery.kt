@@ -0,0 +1,215 @@
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden.data.db
+
+import kotbase.Collection
+import kotbase.DataSource
+import kotbase.DictionaryInterface
+import kotbase.Document
+import kotbase.Expression
+import kotbase.Meta
+import kotbase.Query
+import kotbase.QueryBuilder
+import kotbase.SelectResult
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.flow.Flow
+import kotlinx.coroutines.flow.channelFlow
+import kotlinx.coroutines.flow.flowOn
+import kotlin.coroutines.CoroutineContext
+
+/**
+ * Moves an item from its index in the previous list to its index in the new list
+ */
+data class ListMove(
+    val from: Int,
+    val to: Int,
+)
+
+/**
+ * Difference between two consecutive emissions of a live query.
+ *
+ * inserted and updated hold indices into the new list, removed holds indices
+ * into the previous list.
+ */
+data class ListDelta(
+    val inserted: List<Int> = emptyList(),
+    val updated: List<Int> = emptyList(),
+    val removed: List<Int> = emptyList(),
+    val moved: List<ListMove> = emptyList(),
+) {
+    val isEmpty: Boolean
+        get() = inserted.isEmpty() && updated.isEmpty() && removed.isEmpty() && moved.isEmpty()
+
+    /**
+     * True when only item contents changed, so the list can be patched in place
+     */
+    val isUpdateOnly: Boolean
+        get() = inserted.isEmpty() && removed.isEmpty() && moved.isEmpty()
+}
+
+/**
+ * Full sorted result of a live query together with the change from the previous
+ * emission. The first emission reports every item as inserted.
+ */
+data class ListUpdate<T>(
+    val items: List<T>,
+    val delta: ListDelta,
+) {
+    /**
+     * The same items as a first emission, for a collector that did not see the previous one
+     */
+    internal fun asInitial(): ListUpdate<T> = copy(delta = ListDelta(inserted = items.indices.toList()))
+}
+
+/**
+ * Live query over a collection that only re-reads documents that changed.
+ *
+ * Decoded objects are cached by document id and revision. Collection change
+ * notifications re-read just the reported ids, so editing one document does
+ * not decode the rest of the collection again.
+ *
+ * @param where filter applied to the initial load
+ * @param matches same filter applied to changed documents
+ * @param metrics counters the initial load and each refresh are timed in
+ */
+class LiveCollectionQuery<T : Any>(
+    private val collection: Collection,
+    private val context: CoroutineContext,
+    private val where: Expression?,
+    private val matches: (Document) -> Boolean,
+    private val comparator: Comparator<T>,
+    private val decode: (DictionaryInterface) -> T?,
+    private val metrics: DatabaseMetrics,
+) {
+    private class Entry<T>(val revisionId: String?, val item: T)
+
+    fun asFlow(): Flow<ListUpdate<T>> = channelFlow {
+        val changedIds = Channel<List<String>>(Channel.UNLIMITED)
+        // Registered before the initial load so no change can slip in between
+        val token = collection.addChangeListener { change -> changedIds.trySend(change.documentIDs) }
+        try {
+            val cache = HashMap<String, Entry<T>>()
+            loadAll(cache)
+            var order = sortedIds(cache)
+            send(ListUpdate(order.map { cache.getValue(it).item }, diff(emptyList(), order, emptySet())))
+
+            for (ids in changedIds) {
+                val batch = ids.toMutableSet()
+                while (true) {
+                    batch += changedIds.tryReceive().getOrNull() ?: break
+                }
+                val changed = refresh(cache, batch)
+                if (changed.isEmpty()) continue
+
+                val newOrder = sortedIds(cache)
+                send(ListUpdate(newOrder.map { cache.getValue(it).item }, diff(order, newOrder, changed)))
+                order = newOrder
+            }
+        } finally {
+            token.remove()
+        }
+    }.flowOn(context)
+
+    /**
+     * Query used for the initial load
+     */
+    internal val query: Query by lazy {
+        val from = QueryBuilder.select(
+            SelectResult.expression(Meta.id),
+            SelectResult.expression(Meta.revisionID),
+            SelectResult.all(),
+        ).from(DataSource.collection(collection))
+        where?.let { from.where(it) } ?: from
+    }
+
+    private fun loadAll(cache: MutableMap<String, Entry<T>>) = metrics.timeQuery {
+        query.execute().use { rs ->
+            for (result in rs.allResults()) {
+                val id = result.getString(0) ?: continue
+                val item = result.getDictionary(2)?.let(decode) ?: continue
+                cache[id] = Entry(result.getString(1), item)
+            }
+        }
+    }
+
+    /**
+     * Re-reads the given ids and returns the ones whose cached entry changed
+     */
+    private fun refresh(cache: MutableMap<String, Entry<T>>, ids: Set<String>): Set<String> = metrics.timeQuery {
+        val changed = mutableSetOf<String>()
+        for (id in ids) {
+            val doc = collection.getDocument(id)?.takeIf(matches)
+            if (doc == null) {
+                if (cache.remove(id) != null) changed += id
+                continue
+            }
+            if (cache[id]?.revisionId == doc.revisionID) continue
+
+            val item = decode(doc)
+            if (item == null) {
+                if (cache.remove(id) != null) changed += id
+            } else {
+                cache[id] = Entry(doc.revisionID, item)
+                changed += id
+            }
+        }
+        changed
+    }
+
+    private fun sortedIds(cache: Map<String, Entry<T>>): List<String> {
+        return cache.keys.sortedWith { a, b ->
+            comparator.compare(cache.getValue(a).item, cache.getValue(b).item).takeIf { it != 0 } ?: a.compareTo(b)
+        }
+    }
+
+    companion object {
+        /**
+         * Computes the delta between two orderings of document ids. Moves are
+         * reported for the items outside the longest run that kept its order.
+         */
+        internal fun diff(old: List<String>, new: List<String>, changed: Set<String>): ListDelta {
+            val oldIndex = HashMap<String, Int>(old.size).apply { old.forEachIndexed { index, id -> put(id, index) } }
+            val newIndex = HashMap<String, Int>(new.size).apply { new.forEachIndexed { index, id -> put(id, index) } }
+
+            val removed = old.indices.filter { old[it] !in newIndex }
+            val inserted = new.indices.filter { new[it] !in oldIndex }
+            val updated = new.indices.filter { new[it] in oldIndex && new[it] in changed }
+
+            val common = new.filter { it in oldIndex }
+            val kept = longestIncreasingRun(common.map { oldIndex.getValue(it) })
+            val moved = common.indices
+                .filter { it !in kept }
+                .map { ListMove(oldIndex.getValue(common[it]), newIndex.getValue(common[it])) }
+
+            return ListDelta(inserted = inserted, updated = updated, removed = removed, moved = moved)
+        }
+
+        /**
+         * Positions of one longest strictly increasing subsequence of [values]
+         */
+        private fun longestIncreasingRun(values: List<Int>): Set<Int> {
+            if (values.isEmpty()) return emptySet()
+            val tails = IntArray(values.size)
+            val previous = IntArray(values.size) { -1 }
+            var length = 0
+            for (i in values.indices) {
+                var low = 0
+                var high = length
+                while (low < high) {
+                    val mid = (low + high) ushr 1
+                    if (values[tails[mid]] < values[i]) low = mid + 1 else high = mid
+                }
+                if (low > 0) previous[i] = tails[low - 1]
+                tails[low] = i
+                if (low == length) length++
+            }
+            val run = mutableSetOf<Int>()
+            var position = tails[length - 1]
+            while (position >= 0) {
+                run += position
+                position = previous[position]
+            }
+            return run
+        }
+    }
+}
@@ -0,0 +1,203 @@
+package com.gmg.growmygarden.data.db
+
+import kotlinx.coroutines.CancellationException
+import kotlinx.coroutines.CompletableDeferred
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.selects.select
+import kotlinx.coroutines.withContext
+import kotlin.time.Duration
+import kotlin.time.Duration.Companion.milliseconds
+import kotlin.time.measureTime
+
+/**
+ * Coalescing write-behind queue for a single collection.
+ *
+ * Writes are keyed by document id: the latest write for a key replaces any
+ * pending write for the same key, but writes for other keys are never dropped.
+ * Pending writes are flushed in batches of at most [maxBatchSize] entries, or
+ * after [maxBatchDelay] has passed since the first pending write, inside a
+ * single [kotbase.Database.inBatch] transaction on [DatabaseProvider.writeContext].
+ * [onBatchWritten] runs after each batch is committed.
+ *
+ * A write or purge that throws does not affect the rest of its batch. The
+ * key is tried again with the next batch, up to [maxAttempts] times, unless a
+ * newer write for it replaced it in the meantime. After that it is dropped,
+ * [onWriteFailed] is called and the next [flush] throws the error.
+ *
+ * Queued operations and committed batches are counted in
+ * [DatabaseProvider.metrics].
+ */
+class WriteBehindQueue<K : Any, V : Any>(
+    private val dbProvider: DatabaseProvider,
+    private val maxBatchSize: Int = DEFAULT_MAX_BATCH_SIZE,
+    private val maxBatchDelay: Duration = DEFAULT_MAX_BATCH_DELAY,
+    private val write: (key: K, value: V) -> Unit,
+    private val purge: (key: K) -> Unit,
+    private val onBatchWritten: () -> Unit = {},
+    private val maxAttempts: Int = DEFAULT_MAX_ATTEMPTS,
+    private val onWriteFailed: (key: K, error: Throwable) -> Unit,
+) {
+    private sealed interface Op<out K, out V> {
+        class Put<K, V>(val key: K, val value: V) : Op<K, V>
+        class Remove<K>(val key: K) : Op<K, Nothing>
+        class Flush(val done: CompletableDeferred<Unit>) : Op<Nothing, Nothing>
+    }
+
+    private val incoming = Channel<Op<K, V>>(Channel.UNLIMITED)
+
+    // Only touched by the consumer coroutine. A null value marks a pending purge.
+    private val pending = LinkedHashMap<K, V?>()
+    private val waiters = mutableListOf<CompletableDeferred<Unit>>()
+
+    // Puts and removes accepted since the last batch, including coalesced ones
+    private var acceptedOps = 0
+
+    // Failed attempts of keys waiting to be retried
+    private val attempts = HashMap<K, Int>()
+
+    // First write dropped since waiters were last completed
+    private var droppedError: Throwable? = null
+
+    /**
+     * Queues [value] to be written under [key], replacing any pending write for it
+     */
+    fun put(key: K, value: V) {
+        dbProvider.metrics.queued()
+        incoming.trySend(Op.Put(key, value))
+    }
+
+    /**
+     * Queues a purge of [key], replacing any pending write for it
+     */
+    fun remove(key: K) {
+        dbProvider.metrics.queued()
+        incoming.trySend(Op.Remove(key))
+    }
+
+    /**
+     * Suspends until every write queued before this call has been committed
+     */
+    suspend fun flush() {
+        val done = CompletableDeferred<Unit>()
+        incoming.send(Op.Flush(done))
+        done.await()
+    }
+
+    private fun accept(op: Op<K, V>) {
+        when (op) {
+            is Op.Put -> {
+                pending[op.key] = op.value
+                attempts.remove(op.key)
+                acceptedOps++
+            }
+            is Op.Remove -> {
+                pending[op.key] = null
+                attempts.remove(op.key)
+                acceptedOps++
+            }
+            is Op.Flush -> waiters.add(op.done)
+        }
+    }
+
+    private suspend fun fillBatch() = coroutineScope {
+        val timer = launch { delay(maxBatchDelay) }
+        while (pending.size < maxBatchSize && waiters.isEmpty() && timer.isActive) {
+            select {
+                incoming.onReceive { accept(it) }
+                timer.onJoin { }
+            }
+        }
+        timer.cancel()
+    }
+
+    private suspend fun writeBatch() {
+        val batch = pending.toList()
+        pending.clear()
+        val done = waiters.toList()
+        waiters.clear()
+        val ops = acceptedOps
+        acceptedOps = 0
+
+        val failures = LinkedHashMap<K, Throwable>()
+        if (batch.isNotEmpty()) {
+            val elapsed = measureTime {
+                val result = runCatching {
+                    withContext(dbProvider.writeContext) {
+                        dbProvider.database.inBatch {
+                            for ((key, value) in batch) {
+                                try {
+                                    if (value != null) write(key, value) else purge(key)
+                                } catch (e: CancellationException) {
+                                    throw e
+                                } catch (e: Exception) {
+                                    failures[key] = e
+                                }
+                            }
+                        }
+                    }
+                }
+                // The transaction itself failed, so nothing in it was written
+                result.exceptionOrNull()?.let { error ->
+                    if (error is CancellationException) throw error
+                    batch.forEach { (key, _) -> failures[key] = error }
+                }
+            }
+            dbProvider.metrics.recordWrite(batch.size - failures.size, elapsed)
+            if (failures.size < batch.size) onBatchWritten()
+        }
+
+        // pending is empty here, newer writes for a failed key are still in the channel and replace the retry
+        var retried = 0
+        for ((key, value) in batch) {
+            val error = failures[key]
+            if (error == null) {
+                attempts.remove(key)
+                continue
+            }
+            val attempt = (attempts[key] ?: 0) + 1
+            if (attempt < maxAttempts) {
+                attempts[key] = attempt
+                pending[key] = value
+                retried++
+            } else {
+                attempts.remove(key)
+                onWriteFailed(key, error)
+                droppedError = droppedError ?: error
+            }
+        }
+        dbProvider.metrics.committed(ops - retried)
+        acceptedOps = retried
+
+        if (retried > 0) {
+            // Flushes wait for the retries of the writes queued before them
+            waiters.addAll(done)
+            return
+        }
+        val error = droppedError
+        droppedError = null
+        done.forEach { waiter ->
+            error?.let(waiter::completeExceptionally) ?: waiter.complete(Unit)
+        }
+    }
+
+    init {
+        dbProvider.scope.launch {
+            for (op in incoming) {
+                accept(op)
+                do {
+                    fillBatch()
+                    writeBatch()
+                } while (pending.isNotEmpty())
+            }
+        }
+    }
+
+    companion object {
+        const val DEFAULT_MAX_BATCH_SIZE = 128
+        const val DEFAULT_MAX_ATTEMPTS = 3
+        val DEFAULT_MAX_BATCH_DELAY = 250.milliseconds
+    }
+}
@@ -0,0 +1,29 @@
+package com.gmg.growmygarden.data.image
+
+import io.github.vinceglb.filekit.FileKit
+import io.github.vinceglb.filekit.ImageFormat
+import io.github.vinceglb.filekit.compressImage
+
+/**
+ * Scales encoded image bytes down so neither edge exceeds a maximum
+ */
+fun interface ImageResizer {
+    suspend fun resize(bytes: ByteArray, maxDimension: Int): ByteArray
+}
+
+/**
+ * [ImageResizer] backed by the platform image codecs through FileKit
+ */
+object FileKitImageResizer : ImageResizer {
+    private const val QUALITY = 85
+
+    override suspend fun resize(bytes: ByteArray, maxDimension: Int): ByteArray {
+        return FileKit.compressImage(
+            bytes,
+            quality = QUALITY,
+            maxWidth = maxDimension,
+            maxHeight = maxDimension,
+            imageFormat = ImageFormat.JPEG,
+        )
+    }
+}
@@ -0,0 +1,13 @@
+package com.gmg.growmygarden.data.image
+
+/**
+ * Sizes a plant photo is stored in.
+ *
+ * [maxDimension] bounds the longer edge in pixels, [FULL] keeps the photo
+ * as it was picked.
+ */
+enum class ImageSize(val maxDimension: Int?, val suffix: String) {
+    THUMBNAIL(256, "thumb"),
+    DETAIL(1024, "detail"),
+    FULL(null, "full"),
+}
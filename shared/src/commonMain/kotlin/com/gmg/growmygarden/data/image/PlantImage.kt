@@ -1,5 +1,6 @@
 package com.gmg.growmygarden.data.image
 
+import com.rickclephas.kmp.nativecoroutines.NativeCoroutines
 import kotlinx.serialization.KSerializer
 import kotlinx.serialization.descriptors.PrimitiveKind
 import kotlinx.serialization.descriptors.PrimitiveSerialDescriptor
@@ -11,25 +12,65 @@ import kotlin.io.encoding.ExperimentalEncodingApi
 import kotlin.uuid.ExperimentalUuidApi
 import kotlin.uuid.Uuid
 
+/**
+ * Reference to a plant photo.
+ *
+ * Only the uuid is stored in the plant document, the bytes live in a blob
+ * next to it. Images created from fresh bytes carry them until they are saved,
+ * images read back from the database read them in [loadBytes].
+ */
 @OptIn(ExperimentalUuidApi::class)
 class PlantImage(
     val uuid: Uuid = Uuid.random(),
-    val imageBytes: ByteArray? = null,
+    imageBytes: ByteArray? = null,
 ) {
-    val hqPath: String
-        get() = "img_$(uuid).png"
-    val lqPath: String
-        get() = "img_$(uuid)}_lq.png"
+    /**
+     * Bytes handed in by the caller that have not been written to a blob yet
+     */
+    internal val inlineBytes: ByteArray? = imageBytes
+
+    /**
+     * Loads the bytes from storage, set by the repository that read this image
+     */
+    internal var source: (suspend () -> ByteArray?)? = null
+
+    private var resolvedBytes: ByteArray? = null
+
+    /**
+     * Bytes already in memory, either not saved yet or read by [loadBytes].
+     * Never reads storage, so it is safe to call from the main thread.
+     */
+    val imageBytes: ByteArray?
+        get() = inlineBytes ?: resolvedBytes
+
+    /**
+     * Returns the image bytes, reading them from storage off the calling
+     * thread the first time
+     */
+    @NativeCoroutines
+    suspend fun loadBytes(): ByteArray? {
+        return imageBytes ?: source?.invoke()?.also { resolvedBytes = it }
+    }
+
+    /**
+     * Name of the cached file holding this image at [size]
+     */
+    fun fileName(size: ImageSize): String = "img_${uuid.toHexDashString()}_${size.suffix}"
 }
 
+/**
+ * Serializes a [PlantImage] as its uuid.
+ *
+ * Documents written before images moved to blobs stored "uuid|base64",
+ * those are still decoded so they can be migrated.
+ */
 @OptIn(ExperimentalEncodingApi::class, ExperimentalUuidApi::class)
 object PlantImageSerializer : KSerializer<PlantImage> {
     override val descriptor: SerialDescriptor =
         PrimitiveSerialDescriptor("org.gmg.growmygardner.PlantImage", PrimitiveKind.STRING)
 
     override fun serialize(encoder: Encoder, value: PlantImage) {
-        val base64Data = value.imageBytes?.let { Base64.encode(it) } ?: ""
-        encoder.encodeString("${value.uuid.toHexDashString()}|$base64Data")
+        encoder.encodeString(value.uuid.toHexDashString())
     }
 
     override fun deserialize(decoder: Decoder): PlantImage {
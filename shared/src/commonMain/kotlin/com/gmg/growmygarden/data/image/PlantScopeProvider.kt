@@ -12,4 +12,10 @@ class PlantScopeProvider(
     val writeContext: CoroutineContext = CoroutineName("image-write") + dispatcher.limitedParallelism(1),
     val readContext: CoroutineContext = CoroutineName("image-read") + dispatcher,
     val scope: CoroutineScope = CoroutineScope(writeContext),
-)
+    val resizeParallelism: Int = DEFAULT_RESIZE_PARALLELISM,
+    val resizeContext: CoroutineContext = CoroutineName("image-resize") + dispatcher.limitedParallelism(resizeParallelism),
+) {
+    companion object {
+        const val DEFAULT_RESIZE_PARALLELISM = 2
+    }
+}
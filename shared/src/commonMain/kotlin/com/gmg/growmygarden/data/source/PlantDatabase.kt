@@ -1,35 +1,46 @@
-@file:OptIn(ExperimentalUuidApi::class)
+@file:OptIn(ExperimentalUuidApi::class, ExperimentalAtomicApi::class)
 
 package com.gmg.growmygarden.data.source
 
 import com.gmg.growmygarden.auth.UserManager
 import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.db.DocumentCodec
+import com.gmg.growmygarden.data.db.IndexManager
+import com.gmg.growmygarden.data.db.IndexSpec
+import com.gmg.growmygarden.data.db.ListUpdate
+import com.gmg.growmygarden.data.db.LiveCollectionQuery
+import com.gmg.growmygarden.data.db.WriteBehindQueue
 import com.gmg.growmygarden.data.image.PlantImage
 import com.gmg.growmygarden.data.image.PlantImageSerializer
 import com.rickclephas.kmp.nativecoroutines.NativeCoroutines
+import kotbase.Blob
+import kotbase.DataSource
+import kotbase.DictionaryInterface
+import kotbase.Expression
+import kotbase.Meta
 import kotbase.MutableDocument
-import kotbase.ktx.all
-import kotbase.ktx.asObjectsFlow
-import kotbase.ktx.from
-import kotbase.ktx.orderBy
-import kotbase.ktx.select
-import kotbase.ktx.where
-import kotlinx.coroutines.FlowPreview
-import kotlinx.coroutines.channels.Channel
-import kotlinx.coroutines.delay
+import kotbase.Ordering
+import kotbase.Query
+import kotbase.QueryBuilder
+import kotbase.SelectResult
+import kotbase.queryChangeFlow
+import kotlinx.coroutines.CancellationException
 import kotlinx.coroutines.flow.Flow
-import kotlinx.coroutines.flow.debounce
-import kotlinx.coroutines.flow.launchIn
-import kotlinx.coroutines.flow.onEach
-import kotlinx.coroutines.flow.receiveAsFlow
+import kotlinx.coroutines.flow.SharedFlow
+import kotlinx.coroutines.flow.SharingStarted
+import kotlinx.coroutines.flow.catch
+import kotlinx.coroutines.flow.flow
+import kotlinx.coroutines.flow.map
+import kotlinx.coroutines.flow.shareIn
 import kotlinx.coroutines.launch
+import kotlinx.coroutines.plus
 import kotlinx.coroutines.withContext
 import kotlinx.serialization.Serializable
-import kotlinx.serialization.json.Json
 import kotlinx.serialization.json.JsonIgnoreUnknownKeys
 import kotlin.String
+import kotlin.concurrent.atomics.AtomicReference
+import kotlin.concurrent.atomics.ExperimentalAtomicApi
 import kotlin.time.Duration
-import kotlin.time.Duration.Companion.milliseconds
 import kotlin.uuid.ExperimentalUuidApi
 import kotlin.uuid.Uuid
 
@@ -74,55 +85,163 @@ open class PlantRepository(
     private val userManager: UserManager,
 ) {
     @Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
-    internal val collection by lazy { dbProvider.database.getCollection(COLLECTION_NAME) ?: dbProvider.database.createCollection(COLLECTION_NAME) }
+    internal val collection by lazy {
+        val coll = dbProvider.database.getCollection(COLLECTION_NAME) ?: dbProvider.database.createCollection(COLLECTION_NAME)
+        coll.also { IndexManager.ensureIndexes(it, PLANT_INDEXES) }
+    }
+
+    internal fun livePlants(userId: String?): LiveCollectionQuery<Plant> {
+        return LiveCollectionQuery(
+            collection = collection,
+            context = dbProvider.readContext,
+            where = userId?.let { Expression.property(USER_ID_KEY).equalTo(Expression.string(it)) },
+            matches = { doc -> userId == null || doc.getString(USER_ID_KEY) == userId },
+            comparator = compareByDescending { plant -> plant.name },
+            decode = ::decodePlant,
+            metrics = dbProvider.metrics,
+        )
+    }
+
+    private class SharedPlantUpdates(val userId: String?, val updates: SharedFlow<Result<ListUpdate<Plant>>>)
 
+    private val sharedUpdates = AtomicReference<SharedPlantUpdates?>(null)
+
+    /**
+     * Live query of [userId]'s plants shared by every collector. It starts
+     * with the first collector and stops, dropping its last emission, when
+     * the last one leaves. Errors are passed on to the collectors instead of
+     * failing [DatabaseProvider.scope].
+     */
+    private fun sharedPlantUpdates(userId: String?): SharedFlow<Result<ListUpdate<Plant>>> {
+        sharedUpdates.load()?.takeIf { it.userId == userId }?.let { return it.updates }
+        val updates = livePlants(userId).asFlow()
+            .map { update -> Result.success(update) }
+            .catch { error -> emit(Result.failure(error)) }
+            .shareIn(dbProvider.scope + dbProvider.readContext, SharingStarted.WhileSubscribed(replayExpirationMillis = 0), replay = 1)
+        sharedUpdates.store(SharedPlantUpdates(userId, updates))
+        return updates
+    }
+
+    /**
+     * The current user's plants sorted by name, with the change from the previous emission
+     */
     @NativeCoroutines
-    val plants: Flow<List<Plant>>
-        get() {
-            val query = userManager.user?.let { user ->
-                select(all()) from collection where {
-                    "userId" equalTo user.id
-                } orderBy { "name".descending() }
-            } ?: run { select(all()) from collection orderBy { "name".descending() } }
-
-            return query.asObjectsFlow { json: String ->
-                Json.decodeFromString<Plant>(json)
+    val plantUpdates: Flow<ListUpdate<Plant>>
+        get() = plantUpdates(userManager.user?.id)
+
+    /**
+     * [userId]'s plants sorted by name, with the change from the previous emission
+     */
+    internal fun plantUpdates(userId: String?): Flow<ListUpdate<Plant>> {
+        val shared = sharedPlantUpdates(userId)
+        return flow {
+            var first = true
+            shared.collect { result ->
+                val update = result.getOrThrow()
+                // Joining a running query starts with its latest list, not its last change
+                emit(if (first) update.asInitial() else update)
+                first = false
             }
         }
+    }
+
+    @NativeCoroutines
+    val plants: Flow<List<Plant>>
+        get() = plantUpdates.map { update -> update.items }
+
+    /**
+     * Keyset page of the current user's plants, sorted like [plants]: by
+     * name descending, plants with the same name by uuid ascending.
+     *
+     * Pass the name and uuid of the last plant of the previous page to get
+     * the next one, or null for the first page.
+     */
+    @NativeCoroutines
+    fun plantsPage(afterName: String?, limit: Int, afterId: String? = null): Flow<List<Plant>> {
+        return plantsPageQuery(userManager.user?.id, afterName, afterId, limit)
+            .queryChangeFlow(dbProvider.readContext)
+            .map { change ->
+                change.error?.let { throw it }
+                change.results?.allResults()
+                    ?.mapNotNull { result -> result.getDictionary(0)?.let(::decodePlant) }
+                    ?: emptyList()
+            }
+    }
+
+    internal fun plantsPageQuery(userId: String?, afterName: String?, afterId: String?, limit: Int): Query {
+        val name = Expression.property(NAME_KEY)
+        val conditions = listOfNotNull(
+            userId?.let { Expression.property(USER_ID_KEY).equalTo(Expression.string(it)) },
+            afterName?.let {
+                val before = name.lessThan(Expression.string(it))
+                afterId?.let { id -> before.or(name.equalTo(Expression.string(it)).and(Meta.id.greaterThan(Expression.string(id)))) } ?: before
+            },
+        )
+        // Ties are broken by id ascending, as in LiveCollectionQuery
+        val orderings = arrayOf(Ordering.property(NAME_KEY).descending(), Ordering.expression(Meta.id).ascending())
+        val from = QueryBuilder.select(SelectResult.all()).from(DataSource.collection(collection))
+        val ordered = conditions.reduceOrNull { a, b -> a.and(b) }
+            ?.let { from.where(it).orderBy(*orderings) }
+            ?: from.orderBy(*orderings)
+        return ordered.limit(Expression.intValue(limit))
+    }
+
+    private fun decodePlant(dictionary: DictionaryInterface): Plant {
+        return DocumentCodec.decode<Plant>(dictionary).also(::attachImageSource)
+    }
+
+    private val deletedUuids = mutableSetOf<Uuid>()
+
+    private val writeQueue = WriteBehindQueue<Uuid, Plant>(
+        dbProvider = dbProvider,
+        write = ::writePlant,
+        purge = ::purgePlant,
+        onWriteFailed = dbProvider.metrics::recordFailedWrite,
+    )
 
-    private val saveChannel = Channel<Plant>(Channel.CONFLATED)
     fun savePlant(plant: Plant) {
-        saveChannel.trySend(plant)
+        if (deletedUuids.contains(plant.uuid)) {
+            return
+        }
+        writeQueue.put(plant.uuid, plant)
+    }
+
+    /**
+     * Queues every plant for saving and suspends until all of them are written
+     */
+    @NativeCoroutines
+    suspend fun savePlants(plants: List<Plant>) {
+        plants.forEach(::savePlant)
+        flush()
     }
 
     @NativeCoroutines
     suspend fun savePlants(vararg plants: Plant) {
-        for (plant in plants) {
-            savePlant(plant)
-            delay(debounceTime + 50.milliseconds)
-        }
+        savePlants(plants.asList())
     }
 
-    private val deletedUuids = mutableSetOf<Uuid>()
+    /**
+     * Suspends until every save and delete queued so far has been committed
+     */
+    @NativeCoroutines
+    suspend fun flush() {
+        writeQueue.flush()
+    }
 
     fun delete(plant: Plant) {
-        val docId = plant.uuid.toHexDashString()
         deletedUuids.add(plant.uuid)
-
-        dbProvider.scope.launch {
-            val doc = collection.getDocument(docId)
-            if (doc != null) {
-                collection.purge(doc)
-            }
-        }
+        writeQueue.remove(plant.uuid)
     }
 
     @NativeCoroutines
     suspend fun getPlant(id: String): Plant? {
         return withContext(dbProvider.readContext) {
-            collection.getDocument(id)
-                ?.let(::decodeDocument)
-                ?.let(::docToPlant)
+            dbProvider.metrics.timeQuery {
+                collection.getDocument(id)
+                    ?.let(::decodeDocument)
+                    ?.let(::docToPlant)
+                    ?.also(::attachImageSource)
+            }
         }
     }
 
@@ -148,38 +267,156 @@ open class PlantRepository(
         )
     }
 
+    private fun writePlant(uuid: Uuid, plant: Plant) {
+        val docId = uuid.toHexDashString()
+        val existing = collection.getDocument(docId)
+        val previousImageId = existing?.getString(IMAGE_KEY)?.substringBefore('|')
+        val mutableDoc = existing?.toMutable() ?: MutableDocument(docId)
+        val updated = PlantDoc(
+            uuid = plant.uuid,
+            userId = userManager.user?.id,
+            name = plant.name,
+            scientificName = plant.scientificName,
+            species = plant.species,
+            wateringFrequency = plant.wateringFrequency,
+            wateringNotificationID = plant.wateringNotificationID,
+            fertilizingFrequency = plant.fertilizingFrequency,
+            fertilizerNotificationID = plant.fertilizerNotificationID,
+            trimmingFrequency = plant.trimmingFrequency,
+            trimmingNotificationID = plant.trimmingNotificationID,
+            notes = plant.notes,
+            image = plant.image,
+        )
+        val fieldsChanged = DocumentCodec.encode(updated, mutableDoc)
+        val imageChanged = updateImageBlob(mutableDoc, plant.image, previousImageId)
+        if (existing == null || fieldsChanged || imageChanged) {
+            collection.save(mutableDoc)
+        }
+    }
+
+    /**
+     * Stores new image bytes as a blob, keeping the existing blob when the
+     * image did not change. Blobs are content addressed, so identical photos
+     * share storage.
+     *
+     * @return whether the blob was changed
+     */
+    private fun updateImageBlob(mutableDoc: MutableDocument, image: PlantImage?, previousImageId: String?): Boolean {
+        val unchanged = image != null && previousImageId == image.uuid.toHexDashString() && mutableDoc.getBlob(IMAGE_BLOB_KEY) != null
+        if (unchanged) return false
+
+        val blob = image?.inlineBytes?.let { bytes -> Blob(IMAGE_CONTENT_TYPE, bytes) }
+        if (blob != null) {
+            mutableDoc.setBlob(IMAGE_BLOB_KEY, blob)
+        } else if (mutableDoc.contains(IMAGE_BLOB_KEY)) {
+            mutableDoc.remove(IMAGE_BLOB_KEY)
+        } else {
+            return false
+        }
+        return true
+    }
+
+    private fun attachImageSource(plant: Plant) {
+        plant.image?.source = { loadImageBytes(plant.uuid) }
+    }
+
+    private suspend fun loadImageBytes(uuid: Uuid): ByteArray? {
+        return withContext(dbProvider.readContext) {
+            dbProvider.metrics.timeQuery {
+                collection.getDocument(uuid.toHexDashString())
+                    ?.getBlob(IMAGE_BLOB_KEY)
+                    ?.content
+            }
+        }
+    }
+
+    @Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+    private val metadata by lazy {
+        dbProvider.database.getCollection(METADATA_COLLECTION_NAME) ?: dbProvider.database.createCollection(METADATA_COLLECTION_NAME)
+    }
+
+    /**
+     * Moves photos of documents written before images were stored as blobs
+     * out of the inline base64 "image" string. Migrated documents no longer
+     * match the query, so running it again is a no-op.
+     *
+     * @return number of migrated documents
+     */
+    internal suspend fun migrateInlineImages(): Int {
+        return withContext(dbProvider.writeContext) {
+            val query = QueryBuilder.select(SelectResult.expression(Meta.id))
+                .from(DataSource.collection(collection))
+                .where(Expression.property(IMAGE_KEY).like(Expression.string("%|_%")))
+            val ids = query.execute().use { rs ->
+                rs.allResults().mapNotNull { result -> result.getString(0) }
+            }
+            dbProvider.database.inBatch {
+                for (docId in ids) {
+                    val existing = collection.getDocument(docId) ?: continue
+                    val doc = decodeDocument(existing) ?: continue
+                    val mutableDoc = existing.toMutable()
+                    DocumentCodec.encode(doc, mutableDoc)
+                    updateImageBlob(mutableDoc, doc.image, null)
+                    collection.save(mutableDoc)
+                }
+            }
+            ids.size
+        }
+    }
+
+    /**
+     * Runs [migrateInlineImages] unless a previous run finished it, so the
+     * full collection scan only happens until the first complete migration.
+     * Documents are no longer written with inline images, so none can appear
+     * afterwards.
+     *
+     * @return number of migrated documents, or null if the migration was done before
+     */
+    internal suspend fun migrateInlineImagesOnce(): Int? {
+        val done = withContext(dbProvider.readContext) { metadata.getDocument(INLINE_IMAGE_MIGRATION_ID) != null }
+        if (done) return null
+
+        val migrated = migrateInlineImages()
+        withContext(dbProvider.writeContext) {
+            metadata.save(MutableDocument(INLINE_IMAGE_MIGRATION_ID).setInt(MIGRATED_COUNT_KEY, migrated))
+        }
+        return migrated
+    }
+
     init {
-        @OptIn(FlowPreview::class)
-        saveChannel.receiveAsFlow().debounce(debounceTime).onEach { plant ->
-            if (deletedUuids.contains(plant.uuid)) {
-                return@onEach
+        dbProvider.scope.launch {
+            // Left unfinished, so the next start tries again
+            try {
+                migrateInlineImagesOnce()
+            } catch (e: CancellationException) {
+                throw e
+            } catch (e: Exception) {
+                dbProvider.metrics.recordFailedWrite(INLINE_IMAGE_MIGRATION_ID, e)
             }
-            val coll = collection
-            val doc = coll.getDocument(plant.uuid.toHexDashString())?.let(::decodeDocument) ?: PlantDoc()
-            val updated = doc.copy(
-                uuid = plant.uuid,
-                userId = userManager.user?.id,
-                name = plant.name,
-                scientificName = plant.scientificName,
-                species = plant.species,
-                wateringFrequency = plant.wateringFrequency,
-                wateringNotificationID = plant.wateringNotificationID,
-                fertilizingFrequency = plant.fertilizingFrequency,
-                fertilizerNotificationID = plant.fertilizerNotificationID,
-                trimmingFrequency = plant.trimmingFrequency,
-                trimmingNotificationID = plant.trimmingNotificationID,
-                notes = plant.notes,
-                image = plant.image,
-            )
-            val json = Json.encodeToString(updated)
-            val mutableDoc = MutableDocument(plant.uuid.toHexDashString(), json)
-            coll.save(mutableDoc)
-        }.launchIn(dbProvider.scope)
+        }
+    }
+
+    private fun purgePlant(uuid: Uuid) {
+        collection.getDocument(uuid.toHexDashString())?.let { doc ->
+            collection.purge(doc)
+        }
     }
 
     companion object {
         private const val PLANT_DOC_ID = "plant"
         private const val COLLECTION_NAME = "plants"
-        private val debounceTime = 250.milliseconds
+        private const val USER_ID_KEY = "userId"
+        private const val NAME_KEY = "name"
+        private const val IMAGE_KEY = "image"
+        internal const val IMAGE_BLOB_KEY = "imageBlob"
+        private const val IMAGE_CONTENT_TYPE = "application/octet-stream"
+        internal const val METADATA_COLLECTION_NAME = "metadata"
+        internal const val INLINE_IMAGE_MIGRATION_ID = "inlineImageMigration"
+        private const val MIGRATED_COUNT_KEY = "migratedCount"
+
+        internal val PLANT_INDEXES = listOf(
+            IndexSpec.value("plants_user_name", 1, USER_ID_KEY, NAME_KEY),
+            IndexSpec.value("plants_name", 1, NAME_KEY),
+        )
     }
 }
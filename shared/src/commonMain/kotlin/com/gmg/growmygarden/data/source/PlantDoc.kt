@@ -3,16 +3,18 @@
 
 package com.gmg.growmygarden.data.source
 
+import com.gmg.growmygarden.data.db.DocumentCodec
 import com.gmg.growmygarden.data.image.PlantImage
 import com.gmg.growmygarden.data.image.PlantImageSerializer
 import kotbase.Document
 import kotlinx.serialization.Serializable
-import kotlinx.serialization.json.Json
+import kotlinx.serialization.json.JsonIgnoreUnknownKeys
 import kotlin.time.Duration
 import kotlin.uuid.ExperimentalUuidApi
 import kotlin.uuid.Uuid
 
 @Serializable
+@JsonIgnoreUnknownKeys
 data class PlantDoc(
     val uuid: Uuid = Uuid.random(),
     val userId: String? = null,
@@ -31,7 +33,5 @@ data class PlantDoc(
 )
 
 fun decodeDocument(doc: Document?): PlantDoc? {
-    return doc?.toJSON()?.let { json ->
-        Json.decodeFromString<PlantDoc>(json)
-    }
+    return doc?.let { DocumentCodec.decode<PlantDoc>(it) }
 }
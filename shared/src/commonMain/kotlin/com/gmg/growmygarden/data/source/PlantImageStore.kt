@@ -1,65 +1,142 @@
 package com.gmg.growmygarden.data.source
 
+import com.gmg.growmygarden.data.cache.LruCache
+import com.gmg.growmygarden.data.image.FileKitImageResizer
+import com.gmg.growmygarden.data.image.ImageResizer
+import com.gmg.growmygarden.data.image.ImageSize
 import com.gmg.growmygarden.data.image.PlantImage
 import com.gmg.growmygarden.data.image.PlantScopeProvider
 import com.rickclephas.kmp.nativecoroutines.NativeCoroutines
 import io.github.vinceglb.filekit.FileKit
-import io.github.vinceglb.filekit.ImageFormat
 import io.github.vinceglb.filekit.PlatformFile
-import io.github.vinceglb.filekit.compressImage
+import io.github.vinceglb.filekit.delete
 import io.github.vinceglb.filekit.div
+import io.github.vinceglb.filekit.exists
 import io.github.vinceglb.filekit.filesDir
 import io.github.vinceglb.filekit.readBytes
 import io.github.vinceglb.filekit.write
-import kotlinx.coroutines.FlowPreview
+import kotlinx.coroutines.CancellationException
+import kotlinx.coroutines.CompletableDeferred
 import kotlinx.coroutines.channels.Channel
-import kotlinx.coroutines.flow.debounce
-import kotlinx.coroutines.flow.launchIn
-import kotlinx.coroutines.flow.onEach
-import kotlinx.coroutines.flow.receiveAsFlow
-import kotlin.time.Duration.Companion.milliseconds
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import kotlinx.coroutines.withContext
+import kotlin.uuid.ExperimentalUuidApi
+import kotlin.uuid.Uuid
 
-@OptIn(FlowPreview::class)
+/**
+ * Stores plant photos on disk in every resized [ImageSize]. The original,
+ * [ImageSize.FULL], is saved with the plant as a blob, so it is read from
+ * the [PlantImage] instead of a file.
+ *
+ * Saved photos are queued without dropping any and resized by
+ * [PlantScopeProvider.resizeParallelism] workers. Thumbnails and detail
+ * images that were read recently are also kept in memory.
+ */
+@OptIn(ExperimentalUuidApi::class)
 class PlantImageStore(
     private val scopeProvider: PlantScopeProvider,
+    private val directory: PlatformFile = FileKit.filesDir,
+    private val resizer: ImageResizer = FileKitImageResizer,
 ) {
+    private class ResizeJob(val image: PlantImage, val bytes: ByteArray, val done: CompletableDeferred<Unit>)
 
-    val writeChannel = Channel<Pair<PlantImage, ByteArray>>(Channel.CONFLATED)
+    private val queue = Channel<ResizeJob>(Channel.UNLIMITED)
 
-    fun saveImage(bytes: ByteArray): PlantImage {
-        val img = PlantImage()
-        writeChannel.trySend(
-            img to bytes,
-        )
+    private val mutex = Mutex()
+    private val memory = LruCache<String, ByteArray>(MEMORY_CACHE_SIZE)
+    private val inFlight = mutableMapOf<Uuid, CompletableDeferred<Unit>>()
+
+    /**
+     * Queues [bytes] to be stored in every resized size and returns the image
+     * referencing them. The bytes are also kept on the image so saving
+     * the plant stores the original.
+     */
+    @NativeCoroutines
+    suspend fun saveImage(bytes: ByteArray): PlantImage {
+        val img = PlantImage(imageBytes = bytes)
+        enqueue(img, bytes)
         return img
     }
 
     @NativeCoroutines
     suspend fun saveImage(file: PlatformFile): PlantImage {
-        val img = PlantImage()
-        writeChannel.trySend(
-            img to file.readBytes(),
-        )
-        return img
+        return saveImage(file.readBytes())
     }
 
-    init {
-        writeChannel.receiveAsFlow()
-            .debounce(500.milliseconds)
-            .onEach { (image, bytes) ->
-                val hqFile: PlatformFile = FileKit.filesDir / image.hqPath
-                val lqFile: PlatformFile = FileKit.filesDir / image.lqPath
+    /**
+     * Returns the image [uuid] at [size], waiting for it if it is still being
+     * resized, or null if it was never stored. Always null for
+     * [ImageSize.FULL], which only the plant's [PlantImage] holds.
+     */
+    @NativeCoroutines
+    suspend fun loadImage(uuid: Uuid, size: ImageSize): ByteArray? {
+        if (size == ImageSize.FULL) return null
+        val key = cacheKey(uuid, size)
+        mutex.withLock { memory[key] }?.let { return it }
+        mutex.withLock { inFlight[uuid] }?.join()
+
+        val bytes = withContext(scopeProvider.readContext) {
+            val file = directory / PlantImage(uuid).fileName(size)
+            if (file.exists()) file.readBytes() else null
+        } ?: return null
+        mutex.withLock { memory[key] = bytes }
+        return bytes
+    }
+
+    /**
+     * Returns [image] at [size], generating the resized sizes from the image
+     * bytes if they are not on disk yet
+     */
+    suspend fun loadImage(image: PlantImage, size: ImageSize): ByteArray? {
+        if (size == ImageSize.FULL) return image.loadBytes()
+        loadImage(image.uuid, size)?.let { return it }
+        val original = image.loadBytes() ?: return null
+        enqueue(image, original).join()
+        return loadImage(image.uuid, size)
+    }
 
-                hqFile.write(bytes)
+    private suspend fun enqueue(image: PlantImage, bytes: ByteArray): CompletableDeferred<Unit> = mutex.withLock {
+        inFlight.getOrPut(image.uuid) {
+            CompletableDeferred<Unit>().also { done -> queue.trySend(ResizeJob(image, bytes, done)) }
+        }
+    }
+
+    private suspend fun process(job: ResizeJob) {
+        val result = runCatching {
+            for (size in RESIZED_SIZES) {
+                (directory / job.image.fileName(size)).write(resizer.resize(job.bytes, size.maxDimension!!))
+            }
+        }
+        result.exceptionOrNull()?.let { if (it is CancellationException) throw it }
+
+        mutex.withLock { inFlight.remove(job.image.uuid) }
+        result.exceptionOrNull()?.let(job.done::completeExceptionally) ?: job.done.complete(Unit)
+    }
+
+    private fun cacheKey(uuid: Uuid, size: ImageSize) = "${uuid.toHexDashString()}_${size.suffix}"
+
+    init {
+        repeat(scopeProvider.resizeParallelism) {
+            scopeProvider.scope.launch(scopeProvider.resizeContext) {
+                for (job in queue) {
+                    process(job)
+                }
+            }
+        }
+        scopeProvider.scope.launch {
+            // Every image used to be written to these two names
+            LEGACY_FILE_NAMES
+                .map { directory / it }
+                .filter { it.exists() }
+                .forEach { it.delete() }
+        }
+    }
 
-                lqFile.write(
-                    FileKit.compressImage(
-                        hqFile,
-                        imageFormat = ImageFormat.PNG,
-                        maxWidth = 400,
-                        maxHeight = 400,
-                    ),
-                )
-            }.launchIn(scopeProvider.scope)
+    companion object {
+        private const val MEMORY_CACHE_SIZE = 64
+        private val RESIZED_SIZES = ImageSize.entries.filter { it.maxDimension != null }
+        private val LEGACY_FILE_NAMES = listOf("img_\$(uuid).png", "img_\$(uuid)}_lq.png")
     }
 }
@@ -1,6 +1,11 @@
 package com.gmg.growmygarden.data.source
 
+import com.gmg.growmygarden.data.cache.LruCache
 import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.db.DocumentCodec
+import com.gmg.growmygarden.data.db.IndexManager
+import com.gmg.growmygarden.data.db.IndexSpec
+import com.gmg.growmygarden.data.db.WriteBehindQueue
 import com.gmg.growmygarden.network.PerenualApi
 import com.rickclephas.kmp.nativecoroutines.NativeCoroutines
 import kotbase.DataSource
@@ -8,35 +13,36 @@ import kotbase.Expression
 import kotbase.FullTextFunction
 import kotbase.FullTextIndexItem
 import kotbase.IndexBuilder
-import kotbase.Meta
 import kotbase.MutableDocument
+import kotbase.Ordering
+import kotbase.Query
 import kotbase.QueryBuilder
 import kotbase.SelectResult
-import kotbase.get
 import kotbase.ktx.all
-import kotbase.ktx.asObjectsFlow
 import kotbase.ktx.from
 import kotbase.ktx.orderBy
 import kotbase.ktx.select
-import kotlinx.coroutines.FlowPreview
-import kotlinx.coroutines.channels.Channel
-import kotlinx.coroutines.delay
+import kotbase.queryChangeFlow
 import kotlinx.coroutines.flow.Flow
-import kotlinx.coroutines.flow.debounce
-import kotlinx.coroutines.flow.launchIn
-import kotlinx.coroutines.flow.onEach
-import kotlinx.coroutines.flow.receiveAsFlow
+import kotlinx.coroutines.flow.map
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import kotlinx.coroutines.withContext
+import kotlinx.serialization.KSerializer
 import kotlinx.serialization.SerialName
 import kotlinx.serialization.Serializable
 import kotlinx.serialization.builtins.ListSerializer
 import kotlinx.serialization.builtins.serializer
-import kotlinx.serialization.json.Json
+import kotlinx.serialization.descriptors.SerialDescriptor
+import kotlinx.serialization.encoding.Decoder
+import kotlinx.serialization.encoding.Encoder
 import kotlinx.serialization.json.JsonArray
+import kotlinx.serialization.json.JsonDecoder
 import kotlinx.serialization.json.JsonElement
 import kotlinx.serialization.json.JsonIgnoreUnknownKeys
 import kotlinx.serialization.json.JsonTransformingSerializer
 import kotlin.Int
-import kotlin.time.Duration.Companion.milliseconds
+import kotlin.concurrent.Volatile
 import kotlin.uuid.Uuid
 
 /**
@@ -135,38 +141,60 @@ open class PlantInfoRepository(
 ) {
 
     @Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
-    internal val collection
-        get() = dbProvider.database.createCollection("plantInfo")
+    internal val collection by lazy {
+        dbProvider.database.createCollection(COLLECTION_NAME).also { coll ->
+            IndexManager.ensureIndexes(coll, PLANT_INFO_INDEXES)
+        }
+    }
+
+    internal val plantInfoListQuery by lazy {
+        select(all()) from collection orderBy { "id".descending() }
+    }
 
     @NativeCoroutines
     val plantInfoList: Flow<List<PlantInfo>>
-        get() {
-            val query = select(all()) from collection orderBy { "id".descending() }
-            return query.asObjectsFlow { json: String ->
-                Json { ignoreUnknownKeys = true }.decodeFromString<PlantInfo>(json)
-            }
+        get() = plantInfoListQuery.queryChangeFlow(dbProvider.readContext).map { change ->
+            change.error?.let { throw it }
+            change.results?.allResults()
+                ?.mapNotNull { result -> result.getDictionary(0)?.let { DocumentCodec.decode<PlantInfo>(it) } }
+                ?: emptyList()
         }
 
-    private val saveChannel = Channel<PlantInfo>(Channel.CONFLATED)
+    private val writeQueue = WriteBehindQueue<Uuid, PlantInfo>(
+        dbProvider = dbProvider,
+        write = ::writePlantInfo,
+        onBatchWritten = { writeGeneration++ },
+        purge = { docId ->
+            val coll = collection
+            coll.getDocument(docId.toHexDashString())?.let { doc -> coll.purge(doc) }
+        },
+        onWriteFailed = dbProvider.metrics::recordFailedWrite,
+    )
 
     /**
-     * Take a single PlantInfo object and send it to saveChannel
+     * Take a single PlantInfo object and queue it
      * to be saved to database
      */
     fun savePlantInfo(plantInfo: PlantInfo) {
-        saveChannel.trySend(plantInfo)
+        writeQueue.put(plantInfo.docId, plantInfo)
     }
 
     /**
-     * Take multiple PlantInfo objects and send them
-     * to the saveChannel to be saved in a database
+     * Take multiple PlantInfo objects, queue them to be saved
+     * in a database and wait until all of them are written
      */
     @NativeCoroutines
     suspend fun saveMultiplePlantInfo(vararg multiplePlantInfo: PlantInfo) {
-        for (plantInfo in multiplePlantInfo) {
-            savePlantInfo(plantInfo)
-            delay(300.milliseconds)
-        }
+        multiplePlantInfo.forEach(::savePlantInfo)
+        flush()
+    }
+
+    /**
+     * Suspends until every queued PlantInfo has been written
+     */
+    @NativeCoroutines
+    suspend fun flush() {
+        writeQueue.flush()
     }
 
     /**
@@ -199,94 +227,143 @@ open class PlantInfoRepository(
     }
 
     /**
-     * Receives incoming PlantInfo objects and
-     * converts them to PlantInfoDoc objects that get
-     * stored in a database
+     * Converts a queued PlantInfo object to a PlantInfoDoc
+     * object that gets stored in a database
      */
-    init {
-        @OptIn(FlowPreview::class)
-        saveChannel.receiveAsFlow()
-            .debounce(250.milliseconds)
-            .onEach { plantInfo ->
-                val coll = collection
-                val doc = coll.getDocument(plantInfo.docId.toHexDashString())
-                    ?.let(::decodePlantInfoDocument)
-                    ?: PlantInfoDoc()
-                val updated = doc.copy(
-                    docId = plantInfo.docId,
-                    id = plantInfo.id,
-                    name = plantInfo.name,
-                    scientificName = plantInfo.scientificName?.joinToString(", "),
-                    family = plantInfo.family,
-                    watering = plantInfo.watering,
-                    sunExposure = plantInfo.sunExposure,
-                    image = plantInfo.image,
-                )
-                val json = Json.encodeToString(updated)
-                val mutableDoc = MutableDocument(plantInfo.docId.toHexDashString(), json)
-                coll.save(mutableDoc)
-            }
-            .launchIn(dbProvider.scope)
+    private fun writePlantInfo(docId: Uuid, plantInfo: PlantInfo) {
+        val coll = collection
+        val existing = coll.getDocument(docId.toHexDashString())
+        val mutableDoc = existing?.toMutable() ?: MutableDocument(docId.toHexDashString())
+        val updated = PlantInfoDoc(
+            docId = plantInfo.docId,
+            id = plantInfo.id,
+            name = plantInfo.name,
+            scientificName = plantInfo.scientificName?.joinToString(", "),
+            family = plantInfo.family,
+            watering = plantInfo.watering,
+            sunExposure = plantInfo.sunExposure,
+            image = plantInfo.image,
+        )
+        if (DocumentCodec.encode(updated, mutableDoc) || existing == null) {
+            coll.save(mutableDoc)
+        }
     }
 
+    private val searchMutex = Mutex()
+    private val searchCache = LruCache<String, List<PlantInfo>>(SEARCH_CACHE_SIZE)
+    private var searchCacheGeneration = 0
+
+    // Bumped by the write queue after each commit, cached results from older generations are stale
+    @Volatile
+    private var writeGeneration = 0
+
     /**
-     * Creates a full-index called plantInfoFTSIndex, on the collection
-     * of PlantInfos on the fields "name", "scientificName",
-     * and "family", i.e. sets up the full text search on
-     * PlantInfo database
+     * Ranked full text query over the common name, scientific name and family,
+     * projecting the matching documents so no per-hit fetch is needed
      */
-    init {
-        collection.createIndex(
-            "plantInfoFTSIndex",
-            IndexBuilder.fullTextIndex(
-                FullTextIndexItem.property("name"),
-                FullTextIndexItem.property("scientificName"),
-                FullTextIndexItem.property("family"),
-            ).ignoreAccents(false),
-        )
+    internal fun searchQuery(match: String): Query {
+        val index = Expression.fullTextIndex(PLANT_INFO_FTS_INDEX.versionedName)
+        return QueryBuilder.select(SelectResult.all())
+            .from(DataSource.collection(collection))
+            .where(FullTextFunction.match(index, match))
+            .orderBy(Ordering.expression(FullTextFunction.rank(index)).descending())
+            .limit(Expression.intValue(SEARCH_LIMIT))
     }
 
     /**
-     * Searches local database for PlantInfo objects whose "name",
-     * "scientificName", or "family" matches the query and returns
-     * those objects in a list
+     * Searches local database for PlantInfo objects whose common name,
+     * scientific name, or family starts with the words of the query.
+     * Results are ranked by relevance, recent queries are cached until
+     * the next write.
      */
     suspend fun searchPlantInfo(keyWords: String): List<PlantInfo> {
-        val ftsQuery =
-            QueryBuilder.select(
-                SelectResult.expression(Meta.id),
-            )
-                .from(DataSource.collection(collection))
-                .where(
-                    FullTextFunction.match(
-                        Expression.fullTextIndex("plantInfoFTSIndex"),
-                        keyWords,
-                    ),
-                )
-
-        val ftsResults = ftsQuery.execute().use { rs ->
-            rs.allResults()
+        val match = toPrefixMatch(keyWords) ?: return emptyList()
+        val generation = writeGeneration
+        searchMutex.withLock {
+            if (searchCacheGeneration != generation) {
+                searchCache.clear()
+                searchCacheGeneration = generation
+            }
+            searchCache[match]?.let { return it }
+        }
+
+        val results = withContext(dbProvider.readContext) {
+            dbProvider.metrics.timeQuery {
+                searchQuery(match).execute().use { rs ->
+                    rs.allResults().mapNotNull { result ->
+                        result.getDictionary(0)
+                            ?.let(::decodePlantInfoDocument)
+                            ?.let(::docToPlantInfo)
+                    }
+                }
+            }
         }
 
-        val plantInfoFileID = ftsResults.mapNotNull { result ->
-            result.getString("id")
+        searchMutex.withLock {
+            if (searchCacheGeneration == generation) {
+                searchCache[match] = results
+            }
         }
+        return results
+    }
+
+    companion object {
+        private const val COLLECTION_NAME = "plantInfo"
+        private const val SEARCH_CACHE_SIZE = 32
+        private const val SEARCH_LIMIT = 50
+
+        private val NON_WORD = Regex("[^\\p{L}\\p{Nd}]+")
 
-        return plantInfoFileID.mapNotNull { docId ->
-            collection.getDocument(docId)
-                ?.let(::decodePlantInfoDocument)
-                ?.let(::docToPlantInfo)
+        // Accents are ignored so "jalapeno" finds "Jalapeño", most keyboards make them awkward to type
+        internal val PLANT_INFO_FTS_INDEX = IndexSpec("plantInfoFTS", 1, replaces = listOf("plantInfoFTSIndex")) {
+            IndexBuilder.fullTextIndex(
+                FullTextIndexItem.property("common_name"),
+                FullTextIndexItem.property("scientific_name"),
+                FullTextIndexItem.property("family"),
+            ).ignoreAccents(true)
+        }
+
+        internal val PLANT_INFO_INDEXES = listOf(
+            IndexSpec.value("plantInfo_id", 1, "id"),
+            PLANT_INFO_FTS_INDEX,
+        )
+
+        /**
+         * Turns user input into a full text match where every word is a prefix,
+         * so partially typed words already match
+         */
+        internal fun toPrefixMatch(keyWords: String): String? {
+            val words = keyWords.lowercase().split(NON_WORD).filter { it.isNotEmpty() }
+            return words.takeIf { it.isNotEmpty() }?.joinToString(" ") { "$it*" }
         }
     }
 }
 
-// Custom Serializer for sunlight field (can be List<String> or single String)
-object StringOrListSerializer : JsonTransformingSerializer<List<String>>(ListSerializer(String.serializer())) {
-    override fun transformDeserialize(element: JsonElement): JsonElement {
-        return if (element !is JsonArray) {
-            JsonArray(listOf(element))
-        } else {
-            element
+/**
+ * Custom Serializer for sunlight field (can be List<String> or single String).
+ * Documents are decoded by [DocumentCodec], which reads a single string as a
+ * list of one by itself.
+ */
+object StringOrListSerializer : KSerializer<List<String>> {
+    private val listSerializer = ListSerializer(String.serializer())
+
+    private val jsonSerializer = object : JsonTransformingSerializer<List<String>>(listSerializer) {
+        override fun transformDeserialize(element: JsonElement): JsonElement {
+            return if (element !is JsonArray) {
+                JsonArray(listOf(element))
+            } else {
+                element
+            }
         }
     }
+
+    override val descriptor: SerialDescriptor = listSerializer.descriptor
+
+    override fun serialize(encoder: Encoder, value: List<String>) {
+        listSerializer.serialize(encoder, value)
+    }
+
+    override fun deserialize(decoder: Decoder): List<String> {
+        return if (decoder is JsonDecoder) jsonSerializer.deserialize(decoder) else listSerializer.deserialize(decoder)
+    }
 }
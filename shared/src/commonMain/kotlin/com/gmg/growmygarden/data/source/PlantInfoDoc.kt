@@ -1,9 +1,9 @@
 package com.gmg.growmygarden.data.source
 
-import kotbase.Document
+import com.gmg.growmygarden.data.db.DocumentCodec
+import kotbase.DictionaryInterface
 import kotlinx.serialization.SerialName
 import kotlinx.serialization.Serializable
-import kotlinx.serialization.json.Json
 import kotlin.uuid.Uuid
 
 @Serializable
@@ -31,8 +31,6 @@ data class PlantInfoDoc(
     var image: PlantImageInfo? = null,
 )
 
-fun decodePlantInfoDocument(doc: Document?): PlantInfoDoc? {
-    return doc?.toJSON()?.let { json ->
-        Json { ignoreUnknownKeys = true }.decodeFromString<PlantInfoDoc>(json)
-    }
+fun decodePlantInfoDocument(doc: DictionaryInterface?): PlantInfoDoc? {
+    return doc?.let { DocumentCodec.decode<PlantInfoDoc>(it) }
 }
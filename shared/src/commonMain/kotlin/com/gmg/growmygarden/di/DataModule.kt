@@ -1,5 +1,7 @@
 package di
 
+import com.gmg.growmygarden.data.cache.DatabaseResponseCache
+import com.gmg.growmygarden.data.cache.ResponseCache
 import com.gmg.growmygarden.data.db.DatabaseProvider
 import com.gmg.growmygarden.data.image.PlantScopeProvider
 import com.gmg.growmygarden.data.source.PlantImageStore
@@ -17,11 +19,12 @@ val dataModule = module {
     single<CoroutineDispatcher> { Dispatchers.Default }
     single<CoroutineContext> { get<CoroutineDispatcher>() }
     single<CoroutineScope> { CoroutineScope(get<CoroutineContext>() + SupervisorJob()) }
-    singleOf(::DatabaseProvider)
+    single { DatabaseProvider(get()) }
+    single<ResponseCache> { DatabaseResponseCache(get()) }
 
     singleOf(::PlantRepository)
     singleOf(::PlantInfoRepository)
 
-    singleOf(::PlantScopeProvider)
-    singleOf(::PlantImageStore)
+    single { PlantScopeProvider(get()) }
+    single { PlantImageStore(get()) }
 }
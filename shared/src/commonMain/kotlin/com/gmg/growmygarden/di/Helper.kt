@@ -1,9 +1,16 @@
 package com.gmg.growmygarden.di
 
+import com.gmg.growmygarden.auth.UserManager
 import com.gmg.growmygarden.data.image.PlantImage
 import com.gmg.growmygarden.data.source.Plant
 import com.gmg.growmygarden.data.source.PlantInfoRepository
+import com.gmg.growmygarden.data.source.PlantRepository
+import com.gmg.growmygarden.reminder.ReminderScheduler
 import com.gmg.growmygarden.viewmodel.DashboardViewModel
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.flow.map
+import kotlinx.coroutines.launch
+import org.koin.core.Koin
 import org.koin.core.context.startKoin
 import org.koin.mp.KoinPlatformTools
 import kotlin.time.Duration.Companion.milliseconds
@@ -13,12 +20,38 @@ import kotlin.uuid.Uuid
 fun initKoin(apiKey: String) {
     val context = KoinPlatformTools.defaultContext().getOrNull()
     if (context == null) {
-        startKoin {
+        val koin = startKoin {
             val props = getPropertiesMap().toMutableMap()
             props["PERENUAL_API_KEY"] = apiKey
             properties(props)
             modules(appModule())
-        }
+        }.koin
+        startReminders(koin)
+    }
+}
+
+/**
+ * Keeps the reminders in sync with the current user's plants for as long as
+ * the app runs. Started once here, not per view model, so there is one collector.
+ */
+private fun startReminders(koin: Koin) {
+    val scheduler = koin.get<ReminderScheduler>()
+    val plantRepository = koin.get<PlantRepository>()
+    val userManager = koin.get<UserManager>()
+    koin.get<CoroutineScope>().launch {
+        scheduler.follow(userManager.userUpdates.map { user -> user?.id }) { userId -> plantRepository.plantUpdates(userId) }
+    }
+}
+
+/**
+ * Moves the reminders past the digests that fired while the app was in the
+ * background and registers the next ones. Call when the app becomes active.
+ */
+fun refreshReminders() {
+    val koin = KoinPlatformTools.defaultContext().get()
+    val scheduler = koin.get<ReminderScheduler>()
+    koin.get<CoroutineScope>().launch {
+        scheduler.refresh()
     }
 }
 
@@ -1,9 +1,12 @@
 package di
 
 import com.gmg.growmygarden.NotificationHandler
-import org.koin.core.module.dsl.singleOf
+import com.gmg.growmygarden.createNotificationHandler
+import com.gmg.growmygarden.reminder.DatabaseReminderStore
+import com.gmg.growmygarden.reminder.ReminderScheduler
 import org.koin.dsl.module
 
 val notificationModule = module {
-    singleOf(::NotificationHandler)
+    single<NotificationHandler> { createNotificationHandler() }
+    single { ReminderScheduler(get(), store = DatabaseReminderStore(get())) }
 }
@@ -1,40 +1,102 @@
 package com.gmg.growmygarden.network
 
+import com.gmg.growmygarden.data.cache.ResponseCache
+import com.gmg.growmygarden.data.cache.SingleFlight
 import com.gmg.growmygarden.data.source.PlantInfo
 import io.ktor.client.HttpClient
-import io.ktor.client.call.body
 import io.ktor.client.request.get
 import io.ktor.client.statement.bodyAsBytes
+import io.ktor.client.statement.bodyAsText
+import io.ktor.http.HttpHeaders
+import io.ktor.http.HttpStatusCode
+import io.ktor.http.isSuccess
+import kotlinx.coroutines.async
+import kotlinx.coroutines.awaitAll
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.sync.Semaphore
+import kotlinx.coroutines.sync.withPermit
 import kotlinx.serialization.Serializable
+import kotlinx.serialization.json.Json
+import kotlin.time.Duration
+import kotlin.time.Duration.Companion.days
+import kotlin.time.Duration.Companion.seconds
 
 @Serializable
 data class PerenualListResponse<T>(val data: List<T>)
 
+/**
+ * Client for the Perenual API.
+ *
+ * Responses are cached in [cache] when one is given, identical requests that
+ * are in flight at the same time share one network call, and at most
+ * [maxConcurrentRequests] requests run at once. Rate limited requests are
+ * retried with exponential backoff, or after the server's Retry-After, but
+ * never wait longer than [MAX_BACKOFF].
+ */
 class PerenualApi(
     private val client: HttpClient,
     private val apiKey: String,
+    private val cache: ResponseCache? = null,
+    maxConcurrentRequests: Int = DEFAULT_MAX_CONCURRENT_REQUESTS,
 ) {
+    private val json = Json { ignoreUnknownKeys = true }
+    private val singleFlight = SingleFlight<String, String>()
+    private val requestPermits = Semaphore(maxConcurrentRequests)
 
     /**
      * Search for plants by name/query string.
      * Returns a list of matching PlantInfo objects.
      */
     suspend fun searchPerenualAPI(query: String): List<PlantInfo> {
-        val pulledPlantInfo: PerenualListResponse<PlantInfo> = client.get("species-list") {
-            url.parameters.append("q", query)
-            url.parameters.append("key", apiKey)
-        }.body()
-
-        return pulledPlantInfo.data
+        val body = cachedGet("species-list", listOf("q" to query.trim().lowercase()), SEARCH_TTL)
+        return json.decodeFromString<PerenualListResponse<PlantInfo>>(body).data
     }
 
     /**
      * Get detailed plant info by Perenual ID.
      */
     suspend fun searchPlantInPerenualAPI(id: Int): PlantInfo {
-        return client.get("species/details/$id") {
-            url.parameters.append("key", apiKey)
-        }.body()
+        val body = cachedGet("species/details/$id", emptyList(), DETAILS_TTL)
+        return json.decodeFromString<PlantInfo>(body)
+    }
+
+    /**
+     * Get detailed plant info for several Perenual IDs in parallel.
+     * Results are in the same order as [ids].
+     */
+    suspend fun fetchPlantDetails(ids: List<Int>): List<PlantInfo> = coroutineScope {
+        ids.map { id -> async { searchPlantInPerenualAPI(id) } }.awaitAll()
+    }
+
+    private suspend fun cachedGet(path: String, parameters: List<Pair<String, String>>, ttl: Duration): String {
+        val key = parameters.joinToString(separator = "&", prefix = "$path?") { (name, value) -> "$name=$value" }
+        cache?.get(key, ttl)?.let { return it }
+        return singleFlight.run(key) {
+            cache?.get(key, ttl) ?: fetch(path, parameters).also { body -> cache?.put(key, body) }
+        }
+    }
+
+    private suspend fun fetch(path: String, parameters: List<Pair<String, String>>): String {
+        var backoff = INITIAL_BACKOFF
+        repeat(MAX_ATTEMPTS) {
+            val response = requestPermits.withPermit {
+                client.get(path) {
+                    parameters.forEach { (name, value) -> url.parameters.append(name, value) }
+                    url.parameters.append("key", apiKey)
+                }
+            }
+            if (response.status.isSuccess()) {
+                return response.bodyAsText()
+            }
+            if (response.status != HttpStatusCode.TooManyRequests) {
+                error("Perenual request $path failed: ${response.status}")
+            }
+            val retryAfter = response.headers[HttpHeaders.RetryAfter]?.toLongOrNull()?.seconds
+            delay((retryAfter ?: backoff).coerceAtMost(MAX_BACKOFF))
+            backoff *= 2
+        }
+        error("Perenual request $path still rate limited after $MAX_ATTEMPTS attempts")
     }
 
     /**
@@ -60,7 +122,7 @@ class PerenualApi(
      */
     suspend fun downloadImageFromUrl(imageUrl: String): ByteArray? {
         return try {
-            client.get(imageUrl).bodyAsBytes()
+            requestPermits.withPermit { client.get(imageUrl) }.bodyAsBytes()
         } catch (e: Exception) {
             null
         }
@@ -89,4 +151,13 @@ class PerenualApi(
         val imageBytes = downloadImageFromUrl(imageUrl)
         return plantInfo to imageBytes
     }
+
+    companion object {
+        const val DEFAULT_MAX_CONCURRENT_REQUESTS = 4
+        private const val MAX_ATTEMPTS = 4
+        private val INITIAL_BACKOFF = 1.seconds
+        internal val MAX_BACKOFF = 30.seconds
+        private val SEARCH_TTL = 1.days
+        private val DETAILS_TTL = 7.days
+    }
 }
@@ -0,0 +1,49 @@
+@file:OptIn(ExperimentalTime::class)
+
+package com.gmg.growmygarden.reminder
+
+import com.gmg.growmygarden.data.source.Plant
+import kotlin.time.Duration
+import kotlin.time.ExperimentalTime
+import kotlin.time.Instant
+import kotlin.uuid.Uuid
+
+/**
+ * Recurring care a plant can be reminded of. Reminders for a task are
+ * enabled while the plant has a notification id for it.
+ */
+enum class CareTask(val verb: String, val frequencyOf: (Plant) -> Duration, val notificationIdOf: (Plant) -> Uuid?) {
+    WATER("Water", { it.wateringFrequency }, { it.wateringNotificationID }),
+    FERTILIZE("Fertilize", { it.fertilizingFrequency }, { it.fertilizerNotificationID }),
+    TRIM("Trim", { it.trimmingFrequency }, { it.trimmingNotificationID }),
+}
+
+/**
+ * A single due date of a [CareTask] for a plant
+ */
+data class CareEvent(
+    val plantId: Uuid,
+    val plantName: String,
+    val task: CareTask,
+    val due: Instant,
+)
+
+/**
+ * One notification covering every care event due in the same window.
+ * [time] is the earliest due date among [events].
+ */
+data class ReminderDigest(
+    val id: String,
+    val time: Instant,
+    val events: List<CareEvent>,
+) {
+    val title: String
+        get() = events.singleOrNull()
+            ?.let { "Reminder: ${it.task.verb} ${it.plantName}" }
+            ?: "Garden care: ${events.size} tasks due"
+
+    val body: String
+        get() = events.singleOrNull()
+            ?.let { "It's time to ${it.task.verb.lowercase()} your ${it.plantName}. Make sure to do so soon so that it can stay healthy and grow" }
+            ?: events.joinToString(", ") { "${it.task.verb} ${it.plantName}" }
+}
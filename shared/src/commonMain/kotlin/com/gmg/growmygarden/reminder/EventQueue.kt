@@ -0,0 +1,69 @@
+package com.gmg.growmygarden.reminder
+
+/**
+ * Binary min-heap ordered by [comparator]
+ */
+internal class EventQueue<T>(
+    private val comparator: Comparator<in T>,
+    private val heap: ArrayList<T> = ArrayList(),
+) {
+    val size: Int
+        get() = heap.size
+
+    fun peek(): T? = heap.firstOrNull()
+
+    fun add(item: T) {
+        heap.add(item)
+        siftUp(heap.lastIndex)
+    }
+
+    fun poll(): T? {
+        if (heap.isEmpty()) return null
+        val head = heap[0]
+        val last = heap.removeAt(heap.lastIndex)
+        if (heap.isNotEmpty()) {
+            heap[0] = last
+            siftDown(0)
+        }
+        return head
+    }
+
+    /**
+     * Drops every item not matching [predicate] and restores heap order
+     */
+    fun retainAll(predicate: (T) -> Boolean) {
+        heap.retainAll(predicate)
+        for (index in heap.size / 2 - 1 downTo 0) {
+            siftDown(index)
+        }
+    }
+
+    private fun siftUp(start: Int) {
+        var index = start
+        while (index > 0) {
+            val parent = (index - 1) / 2
+            if (comparator.compare(heap[index], heap[parent]) >= 0) return
+            swap(index, parent)
+            index = parent
+        }
+    }
+
+    private fun siftDown(start: Int) {
+        var index = start
+        while (true) {
+            val left = 2 * index + 1
+            if (left >= heap.size) return
+            val right = left + 1
+            val child = if (right < heap.size && comparator.compare(heap[right], heap[left]) < 0) right else left
+            if (comparator.compare(heap[child], heap[index]) >= 0) return
+            swap(index, child)
+            index = child
+        }
+    }
+
+    private fun swap(a: Int, b: Int) {
+        val item = heap[a]
+        heap[a] = heap[b]
+        heap[b] = item
+    }
+}
@@ -0,0 +1,428 @@
+@file:OptIn(ExperimentalTime::class)
+
+package com.gmg.growmygarden.reminder
+
+import com.gmg.growmygarden.NotificationHandler
+import com.gmg.growmygarden.data.db.ListUpdate
+import com.gmg.growmygarden.data.source.Plant
+import kotlinx.coroutines.flow.Flow
+import kotlinx.coroutines.flow.collectLatest
+import kotlinx.coroutines.flow.distinctUntilChanged
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import kotlinx.datetime.TimeZone
+import kotlinx.datetime.toLocalDateTime
+import kotlin.time.Clock
+import kotlin.time.Duration
+import kotlin.time.Duration.Companion.days
+import kotlin.time.Duration.Companion.hours
+import kotlin.time.Duration.Companion.milliseconds
+import kotlin.time.ExperimentalTime
+import kotlin.time.Instant
+import kotlin.uuid.Uuid
+
+/**
+ * Schedules care reminders for every plant through a bounded number of
+ * notifications.
+ *
+ * Each enabled plant task with a frequency is a series of due dates, starting
+ * when the scheduler first saw it, at the time given to [startAt] or when it
+ * was last marked done. Upcoming events are merged into one [ReminderDigest]
+ * per [digestWindow], and only the nearest [maxNotifications] digests are
+ * registered with the [NotificationHandler].
+ *
+ * The events of the registered digests are kept by window. For every series
+ * its first due date after them waits in a priority queue, which the window
+ * is extended from when digests fire or are emptied. A change only touches the
+ * windows of the series it replaces or removes, and only the digests of those
+ * windows are cancelled or set again.
+ *
+ * Series start times and registered digests are saved in [store], so after a
+ * restart the series continue and the digests of the previous run are
+ * replaced instead of left registered next to the new ones.
+ */
+class ReminderScheduler(
+    private val notificationHandler: NotificationHandler,
+    private val clock: Clock = Clock.System,
+    private val timeZone: TimeZone = TimeZone.currentSystemDefault(),
+    private val digestWindow: Duration = DEFAULT_DIGEST_WINDOW,
+    private val maxNotifications: Int = DEFAULT_MAX_NOTIFICATIONS,
+    private val horizon: Duration = DEFAULT_HORIZON,
+    private val store: ReminderStore? = null,
+) {
+    private data class SeriesKey(val plantId: Uuid, val task: CareTask) {
+        val id: String
+            get() = "${plantId.toHexDashString()}$KEY_SEPARATOR${task.name}"
+    }
+
+    private class Series(val key: SeriesKey, val plantName: String, val frequency: Duration, val start: Instant) {
+        /**
+         * First due date strictly after [now]
+         */
+        fun nextDue(now: Instant): Instant {
+            val elapsed = now - start
+            val periods = if (elapsed.isNegative()) 0L else elapsed.inWholeMilliseconds / frequency.inWholeMilliseconds + 1
+            return start + (frequency.inWholeMilliseconds * periods).milliseconds
+        }
+    }
+
+    private class Occurrence(val series: Series, val due: Instant)
+
+    private val mutex = Mutex()
+    private val series = HashMap<SeriesKey, Series>()
+    private val queue = EventQueue(compareBy<Occurrence> { it.due })
+
+    // First due date of each series that is not in a window yet, its entry in the queue
+    private val next = HashMap<SeriesKey, Occurrence>()
+
+    // Entries in the queue that are no longer the next one of their series, skipped when polled
+    private var staleCount = 0
+
+    // Events of the registered digests by window index, each series listed once per window
+    private val windows = HashMap<Long, HashMap<SeriesKey, CareEvent>>()
+    private val changedWindows = HashSet<Long>()
+
+    // Time the schedule was last advanced to, every event in windows is due after it
+    private var scheduledAt: Instant = Instant.DISTANT_PAST
+
+    private val registered = HashMap<String, ReminderDigest>()
+
+    // Starts of series whose plant was not seen yet, from [startAt] or the store
+    private val pendingStarts = HashMap<SeriesKey, Instant>()
+
+    private var restored = false
+    private var saved: ReminderState? = null
+
+    /**
+     * Digests currently registered with the notification handler, nearest first
+     */
+    val scheduledDigests: List<ReminderDigest>
+        get() = registered.values.sortedBy { it.time }
+
+    /**
+     * Replaces every series with the ones of [plants]
+     */
+    suspend fun sync(plants: List<Plant>) = mutex.withLock {
+        restore()
+        advance()
+        val present = plants.mapTo(HashSet()) { it.uuid }
+        series.keys.filter { it.plantId !in present }.forEach(::removeSeries)
+        plants.forEach(::updateSeries)
+        pendingStarts.keys.removeAll { it.plantId !in present }
+        reschedule()
+    }
+
+    /**
+     * Recomputes the series of a single added or edited plant
+     */
+    suspend fun update(plant: Plant) = mutex.withLock {
+        restore()
+        advance()
+        updateSeries(plant)
+        reschedule()
+    }
+
+    suspend fun remove(plantId: Uuid) = mutex.withLock {
+        restore()
+        advance()
+        removePlantSeries(plantId)
+        reschedule()
+    }
+
+    /**
+     * Restarts the series of [task] for the plant now, moving its next
+     * reminder one full period ahead
+     */
+    suspend fun markDone(plantId: Uuid, task: CareTask) = mutex.withLock {
+        restore()
+        advance()
+        val current = series[SeriesKey(plantId, task)] ?: return@withLock
+        putSeries(Series(current.key, current.plantName, current.frequency, scheduledAt))
+        reschedule()
+    }
+
+    /**
+     * Starts the series of [task] for the plant at [start] instead of when
+     * it is first seen. The plant does not have to be saved yet.
+     */
+    suspend fun startAt(plantId: Uuid, task: CareTask, start: Instant) = mutex.withLock {
+        restore()
+        advance()
+        val key = SeriesKey(plantId, task)
+        val current = series[key]
+        if (current == null) {
+            pendingStarts[key] = start
+        } else {
+            putSeries(Series(key, current.plantName, current.frequency, start))
+        }
+        reschedule()
+    }
+
+    /**
+     * Moves past due series forward and registers the digests that became
+     * the nearest ones. Call when the app comes back to the foreground.
+     */
+    suspend fun refresh() = mutex.withLock {
+        restore()
+        advance()
+        reschedule()
+    }
+
+    /**
+     * Applies each live query update to the schedule. The first emission
+     * replaces every series, later ones only touch the plants in their delta.
+     * Suspends until [updates] completes.
+     */
+    suspend fun follow(updates: Flow<ListUpdate<Plant>>) {
+        var previous: List<Plant>? = null
+        updates.collect { update ->
+            val last = previous
+            if (last == null) {
+                update.items.forEach(::cancelLegacyNotifications)
+                sync(update.items)
+            } else if (!update.delta.isEmpty) {
+                mutex.withLock {
+                    restore()
+                    advance()
+                    update.delta.removed.forEach { index -> removePlantSeries(last[index].uuid) }
+                    (update.delta.inserted + update.delta.updated).forEach { index -> updateSeries(update.items[index]) }
+                    reschedule()
+                }
+            }
+            previous = update.items
+        }
+    }
+
+    /**
+     * Follows the plants of whoever is the current user. Each user in
+     * [userIds] replaces the schedule with their plants from [plantUpdates]
+     * and stops following the previous user's. Suspends until [userIds]
+     * completes.
+     */
+    suspend fun follow(userIds: Flow<String?>, plantUpdates: (userId: String?) -> Flow<ListUpdate<Plant>>) {
+        userIds.distinctUntilChanged().collectLatest { userId -> follow(plantUpdates(userId)) }
+    }
+
+    /**
+     * Plants used to get one repeating notification per task, those are
+     * replaced by the digests
+     */
+    private fun cancelLegacyNotifications(plant: Plant) {
+        listOfNotNull(plant.wateringNotificationID, plant.fertilizerNotificationID, plant.trimmingNotificationID)
+            .forEach { id -> notificationHandler.cancelNotification(id.toString()) }
+    }
+
+    private fun updateSeries(plant: Plant) {
+        for (task in CareTask.entries) {
+            val key = SeriesKey(plant.uuid, task)
+            val frequency = task.frequencyOf(plant)
+            val current = series[key]
+            if (frequency.inWholeMilliseconds <= 0 || task.notificationIdOf(plant) == null) {
+                removeSeries(key)
+                continue
+            }
+            if (current != null && current.frequency == frequency && current.plantName == plant.name) continue
+
+            val start = pendingStarts.remove(key) ?: current?.takeIf { it.frequency == frequency }?.start ?: scheduledAt
+            putSeries(Series(key, plant.name, frequency, start))
+        }
+    }
+
+    private fun removePlantSeries(plantId: Uuid) {
+        CareTask.entries.forEach { task -> removeSeries(SeriesKey(plantId, task)) }
+    }
+
+    private fun putSeries(added: Series) {
+        removeSeries(added.key)
+        series[added.key] = added
+        enqueue(Occurrence(added, added.nextDue(scheduledAt)))
+    }
+
+    /**
+     * Drops the series of [key] and takes its events out of the windows.
+     * Those are its due dates after [scheduledAt] and before its queued one.
+     */
+    private fun removeSeries(key: SeriesKey) {
+        val removed = series.remove(key) ?: return
+        val queued = next.remove(key) ?: return
+        staleCount++
+        var due = removed.nextDue(scheduledAt)
+        while (due < queued.due) {
+            val index = windowOf(due)
+            val events = windows[index]
+            if (events?.remove(key) != null) {
+                changedWindows += index
+                if (events.isEmpty()) windows.remove(index)
+            }
+            due += removed.frequency
+        }
+    }
+
+    private fun enqueue(occurrence: Occurrence) {
+        if (next.put(occurrence.series.key, occurrence) != null) staleCount++
+        queue.add(occurrence)
+    }
+
+    /**
+     * Removes the queue head, which must not be stale, from [next]
+     */
+    private fun pollNext(): Occurrence {
+        val head = queue.poll()!!
+        next.remove(head.series.key)
+        return head
+    }
+
+    private fun isStale(occurrence: Occurrence) = next[occurrence.series.key] !== occurrence
+
+    private fun windowOf(time: Instant): Long = time.toEpochMilliseconds().floorDiv(digestWindow.inWholeMilliseconds)
+
+    /**
+     * Loads the series starts of the previous run and cancels the digests it
+     * registered that have not fired yet, once before the first change
+     */
+    private suspend fun restore() {
+        if (restored) return
+        restored = true
+        val state = store?.load() ?: return
+        for ((id, start) in state.starts) {
+            seriesKeyOf(id)?.let { key -> pendingStarts[key] = start }
+        }
+        val now = clock.now()
+        state.digests.filterValues { time -> time > now }.keys.forEach(notificationHandler::cancelNotification)
+        saved = state
+    }
+
+    private fun seriesKeyOf(id: String): SeriesKey? {
+        val plantId = id.substringBefore(KEY_SEPARATOR)
+        val task = id.substringAfter(KEY_SEPARATOR)
+        return runCatching { SeriesKey(Uuid.parse(plantId), CareTask.valueOf(task)) }.getOrNull()
+    }
+
+    private suspend fun persist() {
+        val store = store ?: return
+        val state = ReminderState(
+            starts = pendingStarts.entries.associate { (key, start) -> key.id to start } +
+                series.values.associate { it.key.id to it.start },
+            digests = registered.mapValues { (_, digest) -> digest.time },
+        )
+        if (state != saved) {
+            store.save(state)
+            saved = state
+        }
+    }
+
+    /**
+     * Moves to the current time: digests that fired leave their windows, the
+     * events in them are done, and series whose queued due date passed
+     * before it got into a window continue from now
+     */
+    private fun advance() {
+        val now = clock.now()
+        if (now <= scheduledAt) return
+        scheduledAt = now
+        val current = windowOf(now)
+        val fired = windows.filter { (index, events) -> index < current || (index == current && events.values.any { it.due <= now }) }
+        for (index in fired.keys) {
+            windows.remove(index)
+            changedWindows += index
+        }
+        while (true) {
+            val head = queue.peek() ?: break
+            if (isStale(head)) {
+                queue.poll()
+                staleCount--
+            } else if (head.due <= now) {
+                pollNext()
+                enqueue(Occurrence(head.series, head.series.nextDue(now)))
+            } else {
+                break
+            }
+        }
+    }
+
+    private suspend fun reschedule() {
+        if (staleCount > series.size) {
+            queue.retainAll { !isStale(it) }
+            staleCount = 0
+        }
+        fillWindows()
+        register()
+        persist()
+    }
+
+    /**
+     * Moves queued due dates into the windows until [maxNotifications]
+     * windows are filled up to [horizon], nearest first
+     */
+    private fun fillWindows() {
+        val end = scheduledAt + horizon
+        while (true) {
+            val head = queue.peek() ?: break
+            if (isStale(head)) {
+                queue.poll()
+                staleCount--
+                continue
+            }
+            if (head.due > end) break
+            val index = windowOf(head.due)
+            if (windows.size >= maxNotifications && index !in windows && index > (windows.keys.maxOrNull() ?: Long.MIN_VALUE)) break
+
+            pollNext()
+            val events = windows.getOrPut(index) { HashMap() }
+            // A series due more than once in a window is only listed once
+            if (head.series.key !in events) {
+                events[head.series.key] = CareEvent(head.series.key.plantId, head.series.plantName, head.series.key.task, head.due)
+                changedWindows += index
+            }
+            enqueue(Occurrence(head.series, head.due + head.series.frequency))
+            if (windows.size > maxNotifications) dropLastWindow()
+        }
+    }
+
+    /**
+     * Removes the farthest window, its series continue from their events in it
+     */
+    private fun dropLastWindow() {
+        val index = windows.keys.max()
+        val events = windows.remove(index) ?: return
+        changedWindows += index
+        for ((key, event) in events) {
+            series[key]?.let { enqueue(Occurrence(it, event.due)) }
+        }
+    }
+
+    /**
+     * Cancels and sets the digests of the windows that changed since the last call
+     */
+    private fun register() {
+        for (index in changedWindows) {
+            val id = "$DIGEST_ID_PREFIX$index"
+            val digest = windows[index]?.values?.sortedWith(EVENT_ORDER)?.let { events -> ReminderDigest(id, events.first().due, events) }
+            val current = registered[id]
+            if (digest == current) continue
+            // Digests that already fired stay in the notification center
+            if (current != null && current.time > scheduledAt) {
+                notificationHandler.cancelNotification(id)
+            }
+            if (digest == null) {
+                registered.remove(id)
+            } else {
+                registered[id] = digest
+                notificationHandler.setOneTimeNotification(id, digest.title, digest.body, digest.time.toLocalDateTime(timeZone))
+            }
+        }
+        changedWindows.clear()
+    }
+
+    companion object {
+        const val DIGEST_ID_PREFIX = "care-digest-"
+        private const val KEY_SEPARATOR = ":"
+
+        private val EVENT_ORDER = compareBy<CareEvent>({ it.due }, { it.plantName }, { it.plantId.toHexDashString() }, { it.task })
+
+        // iOS keeps at most 64 pending notifications per app
+        const val DEFAULT_MAX_NOTIFICATIONS = 48
+        val DEFAULT_DIGEST_WINDOW = 1.hours
+        val DEFAULT_HORIZON = 60.days
+    }
+}
@@ -0,0 +1,73 @@
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+@file:OptIn(ExperimentalTime::class)
+
+package com.gmg.growmygarden.reminder
+
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import kotbase.MutableDocument
+import kotlinx.coroutines.withContext
+import kotlin.time.ExperimentalTime
+import kotlin.time.Instant
+
+/**
+ * What [ReminderScheduler] needs to continue after a restart: the start of
+ * every care series and the digests registered with the notification handler,
+ * both by id
+ */
+data class ReminderState(
+    val starts: Map<String, Instant> = emptyMap(),
+    val digests: Map<String, Instant> = emptyMap(),
+)
+
+/**
+ * Persists the [ReminderState] of a [ReminderScheduler]
+ */
+interface ReminderStore {
+    suspend fun load(): ReminderState
+
+    suspend fun save(state: ReminderState)
+}
+
+/**
+ * [ReminderStore] keeping the state in one document of the "reminders" collection
+ */
+class DatabaseReminderStore(
+    private val dbProvider: DatabaseProvider,
+) : ReminderStore {
+    private val collection by lazy {
+        dbProvider.database.getCollection(COLLECTION_NAME) ?: dbProvider.database.createCollection(COLLECTION_NAME)
+    }
+
+    override suspend fun load(): ReminderState {
+        return withContext(dbProvider.readContext) {
+            val doc = collection.getDocument(STATE_ID) ?: return@withContext ReminderState()
+            ReminderState(
+                starts = doc.getDictionary(STARTS_KEY)?.toMap().toInstants(),
+                digests = doc.getDictionary(DIGESTS_KEY)?.toMap().toInstants(),
+            )
+        }
+    }
+
+    override suspend fun save(state: ReminderState) {
+        withContext(dbProvider.writeContext) {
+            collection.save(
+                MutableDocument(STATE_ID)
+                    .setValue(STARTS_KEY, state.starts.mapValues { (_, time) -> time.toEpochMilliseconds() })
+                    .setValue(DIGESTS_KEY, state.digests.mapValues { (_, time) -> time.toEpochMilliseconds() }),
+            )
+        }
+    }
+
+    private fun Map<String, Any?>?.toInstants(): Map<String, Instant> {
+        return this?.mapNotNull { (id, millis) -> (millis as? Number)?.let { id to Instant.fromEpochMilliseconds(it.toLong()) } }
+            ?.toMap()
+            ?: emptyMap()
+    }
+
+    companion object {
+        private const val COLLECTION_NAME = "reminders"
+        private const val STATE_ID = "schedule"
+        private const val STARTS_KEY = "starts"
+        private const val DIGESTS_KEY = "digests"
+    }
+}
@@ -2,6 +2,8 @@ package com.gmg.growmygarden.viewmodel
 
 import com.gmg.growmygarden.NotificationHandler
 import com.gmg.growmygarden.auth.UserManager
+import com.gmg.growmygarden.data.db.ListUpdate
+import com.gmg.growmygarden.data.image.ImageSize
 import com.gmg.growmygarden.data.image.PlantImage
 import com.gmg.growmygarden.data.source.Plant
 import com.gmg.growmygarden.data.source.PlantImageStore
@@ -9,6 +11,8 @@ import com.gmg.growmygarden.data.source.PlantInfo
 import com.gmg.growmygarden.data.source.PlantInfoRepository
 import com.gmg.growmygarden.data.source.PlantRepository
 import com.gmg.growmygarden.network.PerenualApi
+import com.gmg.growmygarden.reminder.CareTask
+import com.gmg.growmygarden.reminder.ReminderScheduler
 import com.rickclephas.kmp.nativecoroutines.NativeCoroutines
 import com.rickclephas.kmp.nativecoroutines.NativeCoroutinesState
 import com.rickclephas.kmp.observableviewmodel.ViewModel
@@ -17,18 +21,23 @@ import com.rickclephas.kmp.observableviewmodel.stateIn
 import io.github.vinceglb.filekit.FileKit
 import io.github.vinceglb.filekit.dialogs.FileKitType
 import io.github.vinceglb.filekit.dialogs.openFilePicker
+import kotlinx.coroutines.flow.Flow
 import kotlinx.coroutines.flow.SharingStarted
 import kotlinx.coroutines.flow.StateFlow
 import kotlinx.coroutines.flow.first
 import kotlinx.datetime.LocalDateTime
+import kotlinx.datetime.TimeZone
+import kotlinx.datetime.toInstant
 import kotlin.collections.listOf
 import kotlin.time.Duration
+import kotlin.time.ExperimentalTime
 import kotlin.uuid.Uuid
 
 class DashboardViewModel(
     private val plantRepository: PlantRepository,
     private val imageStore: PlantImageStore,
     private val notificationHandler: NotificationHandler,
+    private val reminderScheduler: ReminderScheduler,
     private val perenualAPI: PerenualApi,
     private val plantInfoRepository: PlantInfoRepository,
     private val userManager: UserManager,
@@ -41,6 +50,14 @@ class DashboardViewModel(
         initialValue = listOf<Plant>(),
     )
 
+    /**
+     * Plants with the change since the previous emission. Every emission is
+     * delivered, so collectors can patch their copy of the list in place.
+     */
+    @NativeCoroutines
+    val plantUpdates: Flow<ListUpdate<Plant>>
+        get() = plantRepository.plantUpdates
+
     /**
      * Updates the repository with the current User ID.
      * Call this when the user logs in (with UID) or logs out (with null).
@@ -68,7 +85,7 @@ class DashboardViewModel(
     fun savePlantWithAutoImage(plant: Plant) {
         viewModelScope.launch {
             // If plant already has an image, just save it normally
-            if (plant.image != null && plant.image?.imageBytes != null) {
+            if (plant.image != null) {
                 plantRepository.savePlant(plant)
                 return@launch
             }
@@ -176,48 +193,56 @@ class DashboardViewModel(
     }
 
     /**
-     * Creates a water notification for passed in plant
+     * Sets how often passed in plant needs watering and enables its reminder,
+     * due first at date. The reminders are scheduled by [ReminderScheduler]
+     * once the plant is saved.
      */
+    @Deprecated("Reminders are scheduled by ReminderScheduler from the plant frequencies", ReplaceWith("savePlant(plant)"))
     fun createWaterNotification(date: LocalDateTime, plant: Plant, image: String?, notifcationDelay: Duration) {
-        val title = "Reminder: Water ${plant.name}"
-        val body = "It's time to water your ${plant.name}. Make sure to do so soon so that it can stay healthy and grow"
         plant.wateringFrequency = notifcationDelay
-        val delay: Long = plant.wateringFrequency.inWholeMilliseconds / 60000
-
-        val generatedNotificationID: Uuid = Uuid.random()
-        plant.wateringNotificationID = generatedNotificationID
-
-        notificationHandler.setNotification(generatedNotificationID.toString(), title, body, date, image, delay)
+        if (plant.wateringNotificationID == null) plant.wateringNotificationID = Uuid.random()
+        startReminders(plant, CareTask.WATER, date)
     }
 
     /**
-     * Creates a fertilizer notification for passed in plant
+     * Sets how often passed in plant needs fertilizing and enables its
+     * reminder, due first at date. The reminders are scheduled by
+     * [ReminderScheduler] once the plant is saved.
      */
+    @Deprecated("Reminders are scheduled by ReminderScheduler from the plant frequencies", ReplaceWith("savePlant(plant)"))
     fun createFertilizerNotification(date: LocalDateTime, plant: Plant, image: String?, notifcationDelay: Duration) {
-        val title = "Reminder: Fertilize ${plant.name}"
-        val body = "It's time to give your ${plant.name} some fertilizer. Make sure to do so soon so that it can stay healthy and grow"
         plant.fertilizingFrequency = notifcationDelay
-        val delay: Long = plant.fertilizingFrequency.inWholeMilliseconds / 60000
-
-        val generatedNotificationID: Uuid = Uuid.random()
-        plant.fertilizerNotificationID = generatedNotificationID
-
-        notificationHandler.setNotification(generatedNotificationID.toString(), title, body, date, image, delay)
+        if (plant.fertilizerNotificationID == null) plant.fertilizerNotificationID = Uuid.random()
+        startReminders(plant, CareTask.FERTILIZE, date)
     }
 
     /**
-     * Creates a trimming notification for passed in plant
+     * Sets how often passed in plant needs trimming and enables its reminder,
+     * due first at date. The reminders are scheduled by [ReminderScheduler]
+     * once the plant is saved.
      */
+    @Deprecated("Reminders are scheduled by ReminderScheduler from the plant frequencies", ReplaceWith("savePlant(plant)"))
     fun createTrimmingNotification(date: LocalDateTime, plant: Plant, image: String?, notifcationDelay: Duration) {
-        val title = "Reminder: Trim ${plant.name}"
-        val body = "It's time to trim your ${plant.name}. Make sure to do so soon so that it can stay healthy and grow"
         plant.trimmingFrequency = notifcationDelay
-        val delay: Long = plant.trimmingFrequency.inWholeMilliseconds / 60000
+        if (plant.trimmingNotificationID == null) plant.trimmingNotificationID = Uuid.random()
+        startReminders(plant, CareTask.TRIM, date)
+    }
 
-        val generatedNotificationID: Uuid = Uuid.random()
-        plant.trimmingNotificationID = generatedNotificationID
+    @OptIn(ExperimentalTime::class)
+    private fun startReminders(plant: Plant, task: CareTask, date: LocalDateTime) {
+        viewModelScope.launch {
+            reminderScheduler.startAt(plant.uuid, task, date.toInstant(TimeZone.currentSystemDefault()))
+        }
+    }
 
-        notificationHandler.setNotification(generatedNotificationID.toString(), title, body, date, image, delay)
+    /**
+     * Records that task was just done for passed in plant, so its next
+     * reminder comes one full period from now
+     */
+    fun markCareDone(plant: Plant, task: CareTask) {
+        viewModelScope.launch {
+            reminderScheduler.markDone(plant.uuid, task)
+        }
     }
 
     /**
@@ -272,7 +297,16 @@ class DashboardViewModel(
 
     @NativeCoroutines
     suspend fun getPlantImage(plant: Plant): ByteArray? {
-        return plant.image?.imageBytes
+        return plant.image?.loadBytes()
+    }
+
+    /**
+     * Loads the plant photo scaled to [size], list cells should ask for
+     * [ImageSize.THUMBNAIL] instead of the full photo
+     */
+    @NativeCoroutines
+    suspend fun loadPlantImage(plant: Plant, size: ImageSize): ByteArray? {
+        return plant.image?.let { imageStore.loadImage(it, size) }
     }
 
     init {
@@ -289,9 +323,7 @@ class DashboardViewModel(
 
         val popularPlantIDs = listOf(721, 607, 2774, 855, 1716, 2193, 2961, 1474, 367, 2320)
 
-        val popularPlantsList: List<PlantInfo> = popularPlantIDs.map { id ->
-            perenualAPI.searchPlantInPerenualAPI(id)
-        }
+        val popularPlantsList: List<PlantInfo> = perenualAPI.fetchPlantDetails(popularPlantIDs)
 
         plantInfoRepository.saveMultiplePlantInfo(*popularPlantsList.toTypedArray())
     }
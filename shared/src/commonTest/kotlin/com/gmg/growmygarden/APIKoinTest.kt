@@ -33,4 +33,8 @@ class APIKoinTest : KoinTest {
     fun stop() {
         stopKoin()
     }
+
+    companion object {
+        const val PERENUAL_API_KEY = "test-key"
+    }
 }
@@ -0,0 +1,51 @@
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.data.cache.ResponseCache
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.image.PlantScopeProvider
+import com.gmg.growmygarden.data.source.PlantInfoRepository
+import com.gmg.growmygarden.data.source.PlantRepository
+import com.gmg.growmygarden.di.appModule
+import com.gmg.growmygarden.network.PerenualApi
+import com.gmg.growmygarden.reminder.ReminderScheduler
+import org.koin.core.context.startKoin
+import org.koin.core.context.stopKoin
+import org.koin.test.KoinTest
+import org.koin.test.get
+import kotlin.test.AfterTest
+import kotlin.test.BeforeTest
+import kotlin.test.Test
+import kotlin.test.assertNotNull
+
+/**
+ * Resolves the singletons of the app modules the way the app does at startup,
+ * so a definition Koin cannot build fails here instead of on launch
+ */
+class AppModuleTest : KoinTest {
+
+    @BeforeTest
+    fun setupKoin() {
+        startKoin {
+            properties(mapOf("PERENUAL_API_KEY" to APIKoinTest.PERENUAL_API_KEY))
+            modules(appModule())
+        }
+    }
+
+    @Test
+    fun testSingletonsResolve() {
+        assertNotNull(get<DatabaseProvider>())
+        assertNotNull(get<ResponseCache>())
+        assertNotNull(get<PlantRepository>())
+        assertNotNull(get<PlantInfoRepository>())
+        // PlantImageStore is left out, its files directory needs FileKit set up on the JVM
+        assertNotNull(get<PlantScopeProvider>())
+        assertNotNull(get<NotificationHandler>())
+        assertNotNull(get<ReminderScheduler>())
+        assertNotNull(get<PerenualApi>())
+    }
+
+    @AfterTest
+    fun stop() {
+        stopKoin()
+    }
+}
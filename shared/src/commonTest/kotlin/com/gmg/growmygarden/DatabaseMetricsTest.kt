@@ -0,0 +1,67 @@
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.data.db.DatabaseMetrics
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.db.WriteBehindQueue
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.test.StandardTestDispatcher
+import kotlinx.coroutines.test.runTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFailsWith
+
+@ExperimentalCoroutinesApi
+class DatabaseMetricsTest {
+    val dispatcher = StandardTestDispatcher()
+
+    private val dbProvider = DatabaseProvider(dispatcher = dispatcher)
+    private val written = mutableListOf<String>()
+    private val writeQueue = WriteBehindQueue<String, String>(
+        dbProvider = dbProvider,
+        write = { key, _ ->
+            if (key == "broken") error("Disk full")
+            written += key
+        },
+        purge = { },
+        onWriteFailed = dbProvider.metrics::recordFailedWrite,
+    )
+
+    @Test
+    fun testQueueDepthFollowsWrites() = runTest(dispatcher) {
+        repeat(3) { writeQueue.put("a", "a$it") }
+        writeQueue.put("b", "b")
+        assertEquals(4L, dbProvider.metrics.snapshot().queueDepth)
+
+        writeQueue.flush()
+        val snapshot = dbProvider.metrics.snapshot()
+        assertEquals(listOf("a", "b"), written)
+        assertEquals(0L, snapshot.queueDepth, "Committed writes still counted as queued")
+        assertEquals(4L, snapshot.maxQueueDepth)
+        assertEquals(1L, snapshot.writeBatches)
+        assertEquals(2L, snapshot.writtenDocuments, "Coalesced writes counted as written")
+    }
+
+    @Test
+    fun testDroppedWriteCounted() = runTest(dispatcher) {
+        writeQueue.put("broken", "x")
+        writeQueue.put("a", "a")
+        assertFailsWith<IllegalStateException> { writeQueue.flush() }
+
+        val snapshot = dbProvider.metrics.snapshot()
+        assertEquals(listOf("a"), written)
+        assertEquals(1L, snapshot.failedWrites)
+        assertEquals("Disk full", snapshot.lastWriteError?.message)
+        assertEquals(0L, snapshot.queueDepth, "Dropped write still counted as queued")
+    }
+
+    @Test
+    fun testFailedQueryCounted() {
+        val metrics = DatabaseMetrics()
+        assertFailsWith<IllegalStateException> { metrics.timeQuery { error("Database closed") } }
+        metrics.timeQuery { }
+
+        assertEquals(2L, metrics.snapshot().queries)
+        metrics.reset()
+        assertEquals(0L, metrics.snapshot().queries)
+    }
+}
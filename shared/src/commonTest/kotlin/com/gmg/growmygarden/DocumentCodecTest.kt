@@ -0,0 +1,115 @@
+@file:OptIn(ExperimentalUuidApi::class)
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.data.db.DocumentCodec
+import com.gmg.growmygarden.data.image.PlantImage
+import com.gmg.growmygarden.data.source.PlantDoc
+import com.gmg.growmygarden.data.source.PlantImageInfo
+import com.gmg.growmygarden.data.source.PlantInfo
+import com.gmg.growmygarden.data.source.PlantInfoDoc
+import kotbase.MutableDocument
+import kotlinx.serialization.Serializable
+import kotlinx.serialization.json.Json
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFalse
+import kotlin.test.assertTrue
+import kotlin.time.Duration.Companion.days
+import kotlin.time.Duration.Companion.hours
+import kotlin.uuid.ExperimentalUuidApi
+import kotlin.uuid.Uuid
+
+class DocumentCodecTest {
+    private val plantDoc = PlantDoc(
+        userId = "codec-user",
+        name = "Plant1",
+        species = "Ivy",
+        wateringFrequency = 1.days,
+        wateringNotificationID = Uuid.random(),
+        fertilizingFrequency = 7.days + 5.hours,
+        notes = "North window",
+        image = PlantImage(),
+    )
+
+    private val plantInfoDoc = PlantInfoDoc(
+        id = 721,
+        name = "Tomato",
+        scientificName = "Solanum lycopersicum",
+        family = "Solanaceae",
+        watering = "Frequent",
+        sunExposure = listOf("full sun", "part shade"),
+        image = PlantImageInfo(imageId = 3, mediumUrl = "https://example.com/tomato.jpg"),
+    )
+
+    @Test
+    fun testPlantDocRoundTrip() {
+        val doc = MutableDocument()
+        assertTrue(DocumentCodec.encode(plantDoc, doc))
+
+        val decoded = DocumentCodec.decode<PlantDoc>(doc)
+        assertEquals(plantDoc.copy(image = null), decoded.copy(image = null))
+        assertEquals(plantDoc.image?.uuid, decoded.image?.uuid)
+    }
+
+    @Test
+    fun testOnlyChangedFieldsWritten() {
+        val doc = MutableDocument()
+        DocumentCodec.encode(plantDoc, doc)
+        doc.setString("unknownKey", "kept")
+
+        assertFalse(DocumentCodec.encode(plantDoc.copy(), doc), "Unchanged plant reported as changed")
+        assertTrue(DocumentCodec.encode(plantDoc.copy(notes = "South window"), doc))
+        assertEquals("South window", doc.getString("notes"))
+        assertEquals("kept", doc.getString("unknownKey"), "Unknown key was dropped")
+    }
+
+    @Test
+    fun testPlantInfoDecodedFromDocument() {
+        val doc = MutableDocument()
+        DocumentCodec.encode(plantInfoDoc, doc)
+
+        assertEquals(plantInfoDoc, DocumentCodec.decode<PlantInfoDoc>(doc))
+        val info = DocumentCodec.decode<PlantInfo>(doc)
+        assertEquals(listOf("Solanum lycopersicum"), info.scientificName, "Single string not read as a list")
+        assertEquals(plantInfoDoc.sunExposure, info.sunExposure)
+        assertEquals(plantInfoDoc.image, info.image)
+    }
+
+    @Test
+    fun testCodecMatchesJson() {
+        val docs = List(DOCUMENT_COUNT) { index -> plantDoc.copy(uuid = Uuid.random(), name = "Plant$index") }
+
+        val jsonDecoded = docs.map { plant ->
+            val doc = MutableDocument(plant.uuid.toHexDashString(), Json.encodeToString(plant))
+            Json.decodeFromString<PlantDoc>(doc.toJSON()!!)
+        }
+        val codecDecoded = docs.map { plant ->
+            val doc = MutableDocument(plant.uuid.toHexDashString())
+            DocumentCodec.encode(plant, doc)
+            DocumentCodec.decode<PlantDoc>(doc)
+        }
+
+        assertEquals(jsonDecoded.map { it.copy(image = null) }, codecDecoded.map { it.copy(image = null) })
+    }
+
+    @Test
+    fun testLargeLongChangeWritten() {
+        val doc = MutableDocument()
+        DocumentCodec.encode(Counter(LARGE_LONG), doc)
+
+        assertTrue(DocumentCodec.encode(Counter(LARGE_LONG + 1), doc), "Change below double precision not detected")
+        assertEquals(LARGE_LONG + 1, doc.getLong("value"))
+    }
+
+    @Serializable
+    private data class Counter(val value: Long)
+
+    companion object {
+        const val DOCUMENT_COUNT = 100
+
+        // Smallest Long whose successor has no exact double
+        const val LARGE_LONG = 1L shl 53
+    }
+}
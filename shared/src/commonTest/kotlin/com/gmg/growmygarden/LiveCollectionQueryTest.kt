@@ -0,0 +1,122 @@
+@file:OptIn(ExperimentalUuidApi::class)
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.db.ListDelta
+import com.gmg.growmygarden.data.db.ListMove
+import com.gmg.growmygarden.data.db.ListUpdate
+import com.gmg.growmygarden.data.db.LiveCollectionQuery
+import com.gmg.growmygarden.data.source.Plant
+import di.userModule
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.test.StandardTestDispatcher
+import kotlinx.coroutines.test.runTest
+import org.koin.core.context.startKoin
+import org.koin.core.context.stopKoin
+import org.koin.dsl.module
+import org.koin.test.KoinTest
+import org.koin.test.inject
+import kotlin.test.AfterTest
+import kotlin.test.BeforeTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertNotNull
+import kotlin.test.assertTrue
+import kotlin.uuid.ExperimentalUuidApi
+
+@ExperimentalCoroutinesApi
+class LiveCollectionQueryTest : KoinTest {
+    val examplePlants: List<Plant> = listOf(
+        Plant(name = "Plant1", species = "Ivy"),
+        Plant(name = "Plant2", species = "Fern"),
+        Plant(name = "Plant3", species = "Cactus"),
+    )
+
+    val plantRepository: TestPlantRepository by inject()
+    val dbProvider: DatabaseProvider by inject()
+
+    val dispatcher = StandardTestDispatcher()
+
+    @BeforeTest
+    fun setup() {
+        startKoin {
+            modules(
+                module {
+                    includes(userModule)
+                    single { DatabaseProvider(dispatcher = dispatcher) }
+                    single { TestPlantRepository(get(), get()) }
+                },
+            )
+        }
+        assertNotNull(plantRepository)
+    }
+
+    @Test
+    fun testDiffInsertRemove() {
+        val delta = LiveCollectionQuery.diff(listOf("a", "b", "c"), listOf("a", "c", "d"), emptySet())
+        assertEquals(ListDelta(inserted = listOf(2), removed = listOf(1)), delta)
+    }
+
+    @Test
+    fun testDiffUpdateAndMove() {
+        val delta = LiveCollectionQuery.diff(listOf("a", "b", "c", "d"), listOf("b", "c", "d", "a"), setOf("a"))
+        assertEquals(ListDelta(updated = listOf(3), moved = listOf(ListMove(from = 0, to = 3))), delta)
+    }
+
+    @Test
+    fun testIncrementalUpdate() = runTest(dispatcher) {
+        val updates = Channel<ListUpdate<Plant>>(Channel.UNLIMITED)
+        val job = launch { plantRepository.plantUpdates.collect { updates.send(it) } }
+        assertTrue(updates.receive().items.isEmpty(), "Database was not empty")
+
+        plantRepository.savePlants(examplePlants)
+        var update = updates.receive()
+        while (update.items.size < examplePlants.size) {
+            update = updates.receive()
+        }
+        assertEquals(examplePlants.sortedByDescending { it.name }, update.items, "Plants not sorted by name")
+
+        val edited = examplePlants[1].copy(notes = "edited")
+        plantRepository.savePlants(edited)
+        update = updates.receive()
+        assertEquals(ListDelta(updated = listOf(update.items.indexOf(edited))), update.delta, "Edit was not a single update")
+
+        plantRepository.delete(edited)
+        plantRepository.flush()
+        update = updates.receive()
+        assertEquals(ListDelta(removed = listOf(1)), update.delta, "Delete was not a single removal")
+
+        job.cancel()
+        plantRepository.clearDatabase()
+    }
+
+    @Test
+    fun testCollectorsShareQuery() = runTest(dispatcher) {
+        plantRepository.savePlants(examplePlants)
+        plantRepository.flush()
+        dbProvider.metrics.reset()
+
+        val first = Channel<ListUpdate<Plant>>(Channel.UNLIMITED)
+        val second = Channel<ListUpdate<Plant>>(Channel.UNLIMITED)
+        val firstJob = launch { plantRepository.plantUpdates.collect { first.send(it) } }
+        assertEquals(examplePlants.size, first.receive().items.size)
+        val secondJob = launch { plantRepository.plantUpdates.collect { second.send(it) } }
+
+        val joined = second.receive()
+        assertEquals(ListDelta(inserted = examplePlants.indices.toList()), joined.delta, "Late collector did not start with the full list")
+        assertEquals(1L, dbProvider.metrics.snapshot().queries, "Each collector ran its own query")
+
+        firstJob.cancel()
+        secondJob.cancel()
+        plantRepository.clearDatabase()
+    }
+
+    @AfterTest
+    fun cleanup() {
+        stopKoin()
+    }
+}
@@ -0,0 +1,145 @@
+@file:OptIn(ExperimentalTime::class)
+
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.data.cache.DatabaseResponseCache
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.network.PerenualApi
+import io.ktor.client.HttpClient
+import io.ktor.client.engine.mock.MockEngine
+import io.ktor.client.engine.mock.respond
+import io.ktor.http.HttpHeaders
+import io.ktor.http.HttpStatusCode
+import io.ktor.http.headersOf
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.async
+import kotlinx.coroutines.awaitAll
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.test.StandardTestDispatcher
+import kotlinx.coroutines.test.TestScope
+import kotlinx.coroutines.test.runTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertNull
+import kotlin.test.assertTrue
+import kotlin.time.Clock
+import kotlin.time.Duration.Companion.days
+import kotlin.time.Duration.Companion.milliseconds
+import kotlin.time.Duration.Companion.minutes
+import kotlin.time.ExperimentalTime
+import kotlin.time.Instant
+
+@ExperimentalCoroutinesApi
+class PerenualApiCacheTest {
+    private val dispatcher = StandardTestDispatcher()
+
+    private var nowMillis = 0L
+    private val clock = object : Clock {
+        override fun now(): Instant = Instant.fromEpochMilliseconds(nowMillis)
+    }
+
+    private val requests = mutableListOf<String>()
+    private var running = 0
+    private var maxRunning = 0
+    private var rateLimitedResponses = 0
+    private var retryAfter: String? = null
+
+    private val engine = MockEngine { request ->
+        requests += request.url.encodedPath
+        running++
+        maxRunning = maxOf(maxRunning, running)
+        delay(10.milliseconds)
+        running--
+
+        val path = request.url.encodedPath
+        when {
+            rateLimitedResponses > 0 -> {
+                rateLimitedResponses--
+                respond("", HttpStatusCode.TooManyRequests, retryAfter?.let { headersOf(HttpHeaders.RetryAfter, it) } ?: headersOf())
+            }
+            path.endsWith("species-list") -> respond(SPECIES_LIST_JSON, headers = JSON_HEADERS)
+            else -> respond("""{"id":${path.substringAfterLast('/')},"common_name":"Plant"}""", headers = JSON_HEADERS)
+        }
+    }
+
+    private val cache = DatabaseResponseCache(DatabaseProvider(dispatcher = dispatcher), clock)
+    private val api = PerenualApi(HttpClient(engine), "test", cache, maxConcurrentRequests = MAX_CONCURRENT)
+
+    private fun cacheTest(block: suspend TestScope.() -> Unit) = runTest(dispatcher) {
+        cache.clear()
+        requests.clear()
+        block()
+    }
+
+    @Test
+    fun testIdenticalRequestsCoalesced() = cacheTest {
+        val results = List(5) { async { api.searchPerenualAPI("rose") } }.awaitAll()
+        assertEquals(1, requests.size, "Concurrent identical requests were not coalesced")
+        assertTrue(results.all { it == results.first() })
+    }
+
+    @Test
+    fun testSpeciesLookupsShareCachedResponse() = cacheTest {
+        api.searchPlantAndGetImage("Rose")
+        api.searchPlantBySpecies("rose")
+        api.searchPerenualAPI("Rose ")
+        assertEquals(1, requests.count { it.endsWith("species-list") }, "species-list was requested more than once")
+    }
+
+    @Test
+    fun testCacheExpires() = cacheTest {
+        api.searchPerenualAPI("rose")
+        nowMillis += 2.days.inWholeMilliseconds
+        api.searchPerenualAPI("rose")
+        assertEquals(2, requests.size, "Expired response was served from cache")
+    }
+
+    @Test
+    fun testRateLimitRetried() = cacheTest {
+        rateLimitedResponses = 2
+        val info = api.searchPlantInPerenualAPI(721)
+        assertEquals(721, info.id)
+        assertEquals(3, requests.size, "Rate limited request was not retried")
+    }
+
+    @Test
+    fun testRetryAfterCapped() = cacheTest {
+        rateLimitedResponses = 1
+        retryAfter = 1.days.inWholeSeconds.toString()
+        val start = currentTime
+        api.searchPlantInPerenualAPI(722)
+        assertTrue(currentTime - start < 1.minutes.inWholeMilliseconds, "Waited ${currentTime - start} ms for Retry-After")
+    }
+
+    @Test
+    fun testExpiredResponsesPurged() = cacheTest {
+        cache.put("stale", "{}")
+        nowMillis += 2.days.inWholeMilliseconds
+        cache.put("recent", "{}")
+
+        assertNull(cache.get("stale", 1.days), "Expired response was returned")
+        assertEquals(0, cache.purgeExpired(DatabaseResponseCache.DEFAULT_RETENTION))
+        assertNull(cache.collection.getDocument("stale"), "Expired response still stored after it was read")
+
+        cache.put("unread", "{}")
+        nowMillis += 2.days.inWholeMilliseconds
+        assertEquals(2, cache.purgeExpired(1.days), "Responses older than the retention not purged")
+        assertNull(cache.collection.getDocument("unread"))
+    }
+
+    @Test
+    fun testBatchFetchBounded() = cacheTest {
+        val ids = (1..10).toList()
+        val details = api.fetchPlantDetails(ids)
+        assertEquals(ids, details.map { it.id }, "Batch results out of order")
+        assertEquals(ids.size, requests.size)
+        assertTrue(maxRunning <= MAX_CONCURRENT, "Ran $maxRunning requests at once")
+    }
+
+    companion object {
+        const val MAX_CONCURRENT = 3
+        val JSON_HEADERS = headersOf(HttpHeaders.ContentType, "application/json")
+        const val SPECIES_LIST_JSON =
+            """{"data":[{"id":1,"common_name":"Rose","scientific_name":["Rosa"],"default_image":{"medium_url":"https://example.com/rose.jpg"}}]}"""
+    }
+}
@@ -172,6 +172,32 @@ class PlantDatabaseTest : KoinTest {
         plantRepository.clearDatabase()
     }
 
+    @Test
+    fun testDatabaseBulkInsert() = runTest(dispatcher) {
+        val bulkPlants = List(BULK_PLANT_COUNT) { index ->
+            Plant(name = "Bulk$index", species = "Fern", wateringFrequency = index.days)
+        }
+        plantRepository.savePlants(bulkPlants)
+        for (plant in bulkPlants) {
+            assertEquals(plant, plantRepository.getPlant(plant.uuid), "Bulk insert lost ${plant.name}")
+        }
+        plantRepository.clearDatabase()
+    }
+
+    @Test
+    fun testDatabaseCoalescedUpdate() = runTest(dispatcher) {
+        val normalPlant = examplePlants.first()
+        val otherPlant = examplePlants[1]
+        plantRepository.savePlant(normalPlant)
+        plantRepository.savePlant(otherPlant)
+        plantRepository.savePlant(normalPlant.copy(notes = "first"))
+        plantRepository.savePlant(normalPlant.copy(notes = "second"))
+        plantRepository.flush()
+        assertEquals(normalPlant.copy(notes = "second"), plantRepository.getPlant(normalPlant.uuid), "Latest write did not win")
+        assertEquals(otherPlant, plantRepository.getPlant(otherPlant.uuid), "Write for another plant was lost")
+        plantRepository.clearDatabase()
+    }
+
     @AfterTest
     fun cleanup() {
         stopKoin()
@@ -179,5 +205,6 @@ class PlantDatabaseTest : KoinTest {
 
     companion object {
         const val SPECIES_UPDATED_VALUE = "Poison Oak"
+        const val BULK_PLANT_COUNT = 500
     }
 }
@@ -0,0 +1,140 @@
+@file:OptIn(ExperimentalUuidApi::class, ExperimentalEncodingApi::class)
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.image.PlantImage
+import com.gmg.growmygarden.data.source.Plant
+import com.gmg.growmygarden.data.source.PlantRepository
+import di.userModule
+import kotbase.MutableDocument
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.flow.first
+import kotlinx.coroutines.test.StandardTestDispatcher
+import kotlinx.coroutines.test.runTest
+import kotlinx.serialization.json.Json
+import kotlinx.serialization.json.JsonObject
+import kotlinx.serialization.json.JsonPrimitive
+import org.koin.core.context.startKoin
+import org.koin.core.context.stopKoin
+import org.koin.dsl.module
+import org.koin.test.KoinTest
+import org.koin.test.inject
+import kotlin.io.encoding.Base64
+import kotlin.io.encoding.ExperimentalEncodingApi
+import kotlin.test.AfterTest
+import kotlin.test.BeforeTest
+import kotlin.test.Test
+import kotlin.test.assertContentEquals
+import kotlin.test.assertEquals
+import kotlin.test.assertNotNull
+import kotlin.test.assertNull
+import kotlin.test.assertTrue
+import kotlin.uuid.ExperimentalUuidApi
+
+@ExperimentalCoroutinesApi
+class PlantImageStorageTest : KoinTest {
+    val plantRepository: TestPlantRepository by inject()
+
+    val dispatcher = StandardTestDispatcher()
+
+    @BeforeTest
+    fun setup() {
+        startKoin {
+            modules(
+                module {
+                    includes(userModule)
+                    single { DatabaseProvider(dispatcher = dispatcher) }
+                    single { TestPlantRepository(get(), get()) }
+                },
+            )
+        }
+        assertNotNull(plantRepository)
+    }
+
+    private fun imageBytes(seed: Int): ByteArray = ByteArray(IMAGE_SIZE) { index -> (index * 31 + seed).toByte() }
+
+    /**
+     * Writes a document the way it was stored before images moved to blobs
+     */
+    private fun saveLegacyPlant(plant: Plant, bytes: ByteArray) {
+        val json = Json.encodeToString(plant.copy(image = null))
+        val legacy = JsonObject(
+            Json.parseToJsonElement(json) as JsonObject +
+                ("image" to JsonPrimitive("${plant.image!!.uuid.toHexDashString()}|${Base64.encode(bytes)}")),
+        )
+        plantRepository.collection.save(MutableDocument(plant.uuid.toHexDashString(), legacy.toString()))
+    }
+
+    @Test
+    fun testImageStoredAsBlob() = runTest(dispatcher) {
+        val bytes = imageBytes(1)
+        val plant = Plant(name = "Photographed", image = PlantImage(imageBytes = bytes))
+        plantRepository.savePlants(plant)
+
+        val doc = plantRepository.collection.getDocument(plant.uuid.toHexDashString())
+        assertNotNull(doc, "Plant was not saved")
+        assertEquals(plant.image!!.uuid.toHexDashString(), doc.getString("image"), "Image bytes were stored inline")
+        assertContentEquals(bytes, doc.getBlob(PlantRepository.IMAGE_BLOB_KEY)?.content, "Image blob missing")
+
+        val loaded = plantRepository.getPlant(plant.uuid)
+        assertNull(loaded?.image?.imageBytes, "Image read before it was requested")
+        assertContentEquals(bytes, loaded?.image?.loadBytes(), "Image failed to resolve lazily")
+
+        // Saving again without touching the image keeps the blob
+        plantRepository.savePlants(loaded!!.copy(notes = "watered"))
+        assertContentEquals(bytes, plantRepository.getPlant(plant.uuid)?.image?.loadBytes(), "Image lost on update")
+        plantRepository.clearDatabase()
+    }
+
+    @Test
+    fun testInlineImageMigration() = runTest(dispatcher) {
+        val bytes = imageBytes(2)
+        val plant = Plant(name = "Legacy", image = PlantImage(imageBytes = bytes))
+        saveLegacyPlant(plant, bytes)
+
+        assertEquals(1, plantRepository.migrateInlineImages(), "Legacy document not migrated")
+        assertEquals(0, plantRepository.migrateInlineImages(), "Migration is not idempotent")
+
+        val doc = plantRepository.collection.getDocument(plant.uuid.toHexDashString())
+        assertEquals(plant.image!!.uuid.toHexDashString(), doc?.getString("image"))
+        assertContentEquals(bytes, plantRepository.getPlant(plant.uuid)?.image?.loadBytes())
+        plantRepository.clearDatabase()
+    }
+
+    @Test
+    fun testInlineImageMigrationRunsOnce() = runTest(dispatcher) {
+        plantRepository.migrateInlineImagesOnce()
+        val plant = Plant(name = "Legacy", image = PlantImage(imageBytes = imageBytes(3)))
+        saveLegacyPlant(plant, plant.image!!.inlineBytes!!)
+
+        assertNull(plantRepository.migrateInlineImagesOnce(), "Collection scanned after the migration completed")
+        assertTrue(plantRepository.collection.getDocument(plant.uuid.toHexDashString())?.getString("image")!!.contains("|"))
+        plantRepository.clearDatabase()
+    }
+
+    @Test
+    fun testListQueryWithPhotographedPlants() = runTest(dispatcher) {
+        val plants = List(PHOTOGRAPHED_PLANT_COUNT) { index ->
+            Plant(name = "Plant$index", image = PlantImage(imageBytes = imageBytes(index)))
+        }
+        plants.forEach { plant -> saveLegacyPlant(plant, plant.image!!.inlineBytes!!) }
+        plantRepository.migrateInlineImages()
+
+        val list = plantRepository.plants.first()
+        assertEquals(PHOTOGRAPHED_PLANT_COUNT, list.size)
+        assertTrue(list.all { plant -> plant.image?.let { image -> image.imageBytes == null } == true }, "List query read image data")
+        plantRepository.clearDatabase()
+    }
+
+    @AfterTest
+    fun cleanup() {
+        stopKoin()
+    }
+
+    companion object {
+        const val IMAGE_SIZE = 32 * 1024
+        const val PHOTOGRAPHED_PLANT_COUNT = 500
+    }
+}
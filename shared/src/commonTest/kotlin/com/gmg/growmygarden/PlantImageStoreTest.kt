@@ -0,0 +1,113 @@
+@file:OptIn(ExperimentalUuidApi::class)
+
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.data.image.ImageResizer
+import com.gmg.growmygarden.data.image.ImageSize
+import com.gmg.growmygarden.data.image.PlantImage
+import com.gmg.growmygarden.data.image.PlantScopeProvider
+import com.gmg.growmygarden.data.source.PlantImageStore
+import io.github.vinceglb.filekit.delete
+import io.github.vinceglb.filekit.div
+import io.github.vinceglb.filekit.exists
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.test.StandardTestDispatcher
+import kotlinx.coroutines.test.runTest
+import kotlin.test.Test
+import kotlin.test.assertContentEquals
+import kotlin.test.assertEquals
+import kotlin.test.assertFalse
+import kotlin.test.assertNotEquals
+import kotlin.test.assertNull
+import kotlin.test.assertTrue
+import kotlin.time.Duration.Companion.milliseconds
+import kotlin.uuid.ExperimentalUuidApi
+import kotlin.uuid.Uuid
+
+@ExperimentalCoroutinesApi
+class PlantImageStoreTest {
+    val dispatcher = StandardTestDispatcher()
+
+    private var running = 0
+    private var maxRunning = 0
+    private var resizeCount = 0
+
+    // Truncates instead of decoding, so sizes can be told apart by length
+    private val resizer = ImageResizer { bytes, maxDimension ->
+        resizeCount++
+        running++
+        maxRunning = maxOf(maxRunning, running)
+        delay(10.milliseconds)
+        running--
+        bytes.copyOf(minOf(bytes.size, maxDimension))
+    }
+
+    private val imageStore = PlantImageStore(
+        PlantScopeProvider(dispatcher, resizeParallelism = RESIZE_PARALLELISM),
+        directory = testCacheDir(),
+        resizer = resizer,
+    )
+
+    private fun imageBytes(seed: Int): ByteArray = ByteArray(IMAGE_SIZE) { index -> (index * 31 + seed).toByte() }
+
+    private suspend fun deleteFiles(images: List<PlantImage>) {
+        images.forEach { image ->
+            ImageSize.entries
+                .map { testCacheDir() / image.fileName(it) }
+                .filter { it.exists() }
+                .forEach { it.delete() }
+        }
+    }
+
+    @Test
+    fun testFileNamesUnique() {
+        val first = PlantImage()
+        val second = PlantImage()
+        assertNotEquals(first.fileName(ImageSize.FULL), second.fileName(ImageSize.FULL))
+        assertNotEquals(first.fileName(ImageSize.FULL), first.fileName(ImageSize.THUMBNAIL))
+    }
+
+    @Test
+    fun testRapidSavesAllStored() = runTest(dispatcher) {
+        val originals = List(IMAGE_COUNT) { imageBytes(it) }
+        val images = originals.map { imageStore.saveImage(it) }
+
+        images.zip(originals).forEach { (image, original) ->
+            assertContentEquals(original, imageStore.loadImage(image, ImageSize.FULL), "Full image lost")
+            assertFalse((testCacheDir() / image.fileName(ImageSize.FULL)).exists(), "Original stored on disk next to its blob")
+            assertEquals(ImageSize.THUMBNAIL.maxDimension, imageStore.loadImage(image.uuid, ImageSize.THUMBNAIL)?.size)
+            assertEquals(ImageSize.DETAIL.maxDimension, imageStore.loadImage(image.uuid, ImageSize.DETAIL)?.size)
+        }
+        assertTrue(maxRunning <= RESIZE_PARALLELISM, "Ran $maxRunning resizes at once")
+        deleteFiles(images)
+    }
+
+    @Test
+    fun testThumbnailServedFromMemory() = runTest(dispatcher) {
+        val image = imageStore.saveImage(imageBytes(0))
+        val thumbnail = imageStore.loadImage(image.uuid, ImageSize.THUMBNAIL)
+        deleteFiles(listOf(image))
+
+        assertContentEquals(thumbnail, imageStore.loadImage(image.uuid, ImageSize.THUMBNAIL), "Thumbnail not cached")
+        assertNull(imageStore.loadImage(image.uuid, ImageSize.DETAIL))
+    }
+
+    @Test
+    fun testMissingSizesGeneratedFromImage() = runTest(dispatcher) {
+        val image = PlantImage(Uuid.random(), imageBytes(1))
+        assertNull(imageStore.loadImage(image.uuid, ImageSize.THUMBNAIL))
+
+        assertEquals(ImageSize.THUMBNAIL.maxDimension, imageStore.loadImage(image, ImageSize.THUMBNAIL)?.size)
+        val resizes = resizeCount
+        imageStore.loadImage(image, ImageSize.DETAIL)
+        assertEquals(resizes, resizeCount, "Stored sizes were generated again")
+        deleteFiles(listOf(image))
+    }
+
+    companion object {
+        const val IMAGE_SIZE = 2048
+        const val IMAGE_COUNT = 6
+        const val RESIZE_PARALLELISM = 2
+    }
+}
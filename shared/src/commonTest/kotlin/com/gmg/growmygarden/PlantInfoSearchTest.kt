@@ -0,0 +1,118 @@
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.source.PlantInfo
+import com.gmg.growmygarden.data.source.PlantInfoRepository
+import com.gmg.growmygarden.network.PerenualApi
+import io.ktor.client.HttpClient
+import io.ktor.client.engine.mock.MockEngine
+import io.ktor.client.engine.mock.respondError
+import io.ktor.http.HttpStatusCode
+import kotbase.Meta
+import kotbase.ktx.from
+import kotbase.ktx.select
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.test.StandardTestDispatcher
+import kotlinx.coroutines.test.runTest
+import org.koin.core.context.startKoin
+import org.koin.core.context.stopKoin
+import org.koin.dsl.module
+import org.koin.test.KoinTest
+import org.koin.test.inject
+import kotlin.test.AfterTest
+import kotlin.test.BeforeTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertNotNull
+import kotlin.test.assertNull
+import kotlin.test.assertTrue
+
+@ExperimentalCoroutinesApi
+class PlantInfoSearchTest : KoinTest {
+    val catalog: List<PlantInfo> = listOf(
+        PlantInfo(id = 1, name = "Tomato", scientificName = listOf("Solanum lycopersicum"), family = "Solanaceae"),
+        PlantInfo(id = 2, name = "Potato", scientificName = listOf("Solanum tuberosum"), family = "Solanaceae"),
+        PlantInfo(id = 3, name = "Rose", scientificName = listOf("Rosa rubiginosa"), family = "Rosaceae"),
+    )
+
+    val plantInfoRepository: PlantInfoRepository by inject()
+
+    val dispatcher = StandardTestDispatcher()
+
+    @BeforeTest
+    fun setup() {
+        startKoin {
+            modules(
+                module {
+                    single { DatabaseProvider(dispatcher = dispatcher) }
+                    single { PerenualApi(HttpClient(MockEngine { respondError(HttpStatusCode.NotFound) }), "test") }
+                    single { PlantInfoRepository(get(), get()) }
+                },
+            )
+        }
+        assertNotNull(plantInfoRepository)
+    }
+
+    private fun clearDatabase() {
+        val collection = plantInfoRepository.collection
+        (select(Meta.id) from collection).execute().use { results ->
+            results.allResults().forEach { result ->
+                result.getString(0)?.let { id -> collection.purge(id) }
+            }
+        }
+    }
+
+    @Test
+    fun testPrefixMatch() {
+        assertEquals("tom*", PlantInfoRepository.toPrefixMatch("Tom"))
+        assertEquals("solanum* lyc*", PlantInfoRepository.toPrefixMatch("  Solanum \"lyc"))
+        assertNull(PlantInfoRepository.toPrefixMatch(" ,. "))
+    }
+
+    @Test
+    fun testSearchQueriesUseIndexes() {
+        assertTrue(plantInfoRepository.searchQuery("tom*").explain().contains("plantInfoFTS_v1"), "Search does not use the FTS index")
+        assertTrue(plantInfoRepository.plantInfoListQuery.explain().contains("plantInfo_id_v1"), "List does not use the id index")
+    }
+
+    @Test
+    fun testSearchStoredFields() = runTest(dispatcher) {
+        plantInfoRepository.saveMultiplePlantInfo(*catalog.toTypedArray())
+
+        assertEquals(listOf("Tomato"), plantInfoRepository.searchPlantInfo("tom").map { it.name }, "Common name prefix")
+        assertEquals(listOf("Potato"), plantInfoRepository.searchPlantInfo("tuberosum").map { it.name }, "Scientific name")
+        assertEquals(setOf("Tomato", "Potato"), plantInfoRepository.searchPlantInfo("Solanaceae").map { it.name }.toSet(), "Family")
+        assertEquals(listOf("Solanum lycopersicum"), plantInfoRepository.searchPlantInfo("tomato").single().scientificName)
+        clearDatabase()
+    }
+
+    @Test
+    fun testSearchIgnoresAccents() = runTest(dispatcher) {
+        plantInfoRepository.saveMultiplePlantInfo(
+            PlantInfo(id = 5, name = "Jalapeño", scientificName = listOf("Capsicum annuum"), family = "Solanaceae"),
+            PlantInfo(id = 6, name = "Dittany", scientificName = listOf("Dictamnus albus"), family = "Rutaceae"),
+        )
+
+        assertEquals(listOf("Jalapeño"), plantInfoRepository.searchPlantInfo("jalapeno").map { it.name }, "Unaccented query")
+        assertEquals(listOf("Jalapeño"), plantInfoRepository.searchPlantInfo("Jalapeño").map { it.name }, "Accented query")
+        assertEquals(listOf("Dittany"), plantInfoRepository.searchPlantInfo("díctamnus").map { it.name }, "Accent only in the query")
+        clearDatabase()
+    }
+
+    @Test
+    fun testSearchCacheInvalidatedOnWrite() = runTest(dispatcher) {
+        plantInfoRepository.saveMultiplePlantInfo(*catalog.toTypedArray())
+        assertTrue(plantInfoRepository.searchPlantInfo("bas").isEmpty())
+
+        plantInfoRepository.saveMultiplePlantInfo(PlantInfo(id = 4, name = "Basil", family = "Lamiaceae"))
+        assertEquals(listOf("Basil"), plantInfoRepository.searchPlantInfo("bas").map { it.name }, "Stale cached result")
+        clearDatabase()
+    }
+
+    @AfterTest
+    fun cleanup() {
+        stopKoin()
+    }
+}
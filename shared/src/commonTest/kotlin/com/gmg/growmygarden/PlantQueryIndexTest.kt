@@ -0,0 +1,131 @@
+@file:OptIn(ExperimentalUuidApi::class)
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.auth.UserManager
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.source.Plant
+import com.gmg.growmygarden.data.source.PlantRepository
+import di.userModule
+import kotbase.Query
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.flow.first
+import kotlinx.coroutines.test.StandardTestDispatcher
+import kotlinx.coroutines.test.runTest
+import org.koin.core.context.startKoin
+import org.koin.core.context.stopKoin
+import org.koin.dsl.module
+import org.koin.test.KoinTest
+import org.koin.test.inject
+import kotlin.test.AfterTest
+import kotlin.test.BeforeTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertNotNull
+import kotlin.test.assertTrue
+import kotlin.uuid.ExperimentalUuidApi
+
+@ExperimentalCoroutinesApi
+class PlantQueryIndexTest : KoinTest {
+    val plantRepository: TestPlantRepository by inject()
+    val userManager: UserManager by inject()
+
+    val dispatcher = StandardTestDispatcher()
+
+    @BeforeTest
+    fun setup() {
+        startKoin {
+            modules(
+                module {
+                    includes(userModule)
+                    single { DatabaseProvider(dispatcher = dispatcher) }
+                    single { TestPlantRepository(get(), get()) }
+                },
+            )
+        }
+        assertNotNull(plantRepository)
+    }
+
+    private fun assertUsesIndex(query: Query, indexName: String) {
+        val plan = query.explain()
+        assertTrue(plan.contains(indexName), "Query does not use $indexName:\n$plan")
+    }
+
+    @Test
+    fun testIndexesCreated() {
+        val indexes = plantRepository.collection.indexes
+        PlantRepository.PLANT_INDEXES.forEach { spec ->
+            assertTrue(spec.versionedName in indexes, "Missing index ${spec.versionedName}")
+        }
+    }
+
+    @Test
+    fun testPlantsQueryUsesIndex() {
+        assertUsesIndex(plantRepository.livePlants(TEST_USER).query, "plants_user_name_v1")
+    }
+
+    @Test
+    fun testPageQueriesUseIndex() {
+        assertUsesIndex(plantRepository.plantsPageQuery(TEST_USER, null, null, PAGE_SIZE), "plants_user_name_v1")
+        assertUsesIndex(plantRepository.plantsPageQuery(TEST_USER, "Plant5", "id", PAGE_SIZE), "plants_user_name_v1")
+        assertUsesIndex(plantRepository.plantsPageQuery(null, "Plant5", null, PAGE_SIZE), "plants_name_v1")
+    }
+
+    @Test
+    fun testKeysetPagination() = runTest(dispatcher) {
+        userManager.login(TEST_USER)
+        // Duplicate names make sure ties are broken by id
+        val plants = List(PLANT_COUNT) { index -> Plant(name = "Plant${index / 2}") }
+        plantRepository.savePlants(plants)
+
+        val pages = mutableListOf<Plant>()
+        var last: Plant? = null
+        do {
+            val page = plantRepository.plantsPage(last?.name, PAGE_SIZE, last?.uuid?.toHexDashString()).first()
+            assertTrue(page.size <= PAGE_SIZE, "Page larger than limit")
+            pages += page
+            last = page.lastOrNull()
+        } while (page.size == PAGE_SIZE)
+
+        assertEquals(PLANT_COUNT, pages.size, "Pages skipped or repeated plants")
+        assertEquals(plants.map { it.uuid }.toSet(), pages.map { it.uuid }.toSet())
+        assertEquals(pages.sortedByDescending { it.name }.map { it.name }, pages.map { it.name }, "Pages not sorted by name")
+
+        userManager.logout()
+        plantRepository.clearDatabase()
+    }
+
+    @Test
+    fun testPagesMatchLiveOrder() = runTest(dispatcher) {
+        userManager.login(TEST_USER)
+        // Only two names, so most neighbours are ties
+        plantRepository.savePlants(List(PLANT_COUNT) { index -> Plant(name = "Plant${index % 2}") })
+        plantRepository.flush()
+
+        val pages = mutableListOf<Plant>()
+        var last: Plant? = null
+        do {
+            val page = plantRepository.plantsPage(last?.name, PAGE_SIZE, last?.uuid?.toHexDashString()).first()
+            pages += page
+            last = page.lastOrNull()
+        } while (page.size == PAGE_SIZE)
+
+        val live = plantRepository.plants.first()
+        assertEquals(live.map { it.uuid }, pages.map { it.uuid }, "Pages and the live list order equal names differently")
+
+        userManager.logout()
+        plantRepository.clearDatabase()
+    }
+
+    @AfterTest
+    fun cleanup() {
+        stopKoin()
+    }
+
+    companion object {
+        const val TEST_USER = "index-test-user"
+        const val PLANT_COUNT = 25
+        const val PAGE_SIZE = 10
+    }
+}
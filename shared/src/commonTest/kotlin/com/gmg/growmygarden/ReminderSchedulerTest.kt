@@ -0,0 +1,235 @@
+@file:OptIn(ExperimentalTime::class, ExperimentalCoroutinesApi::class)
+
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.data.db.ListDelta
+import com.gmg.growmygarden.data.db.ListUpdate
+import com.gmg.growmygarden.data.source.Plant
+import com.gmg.growmygarden.reminder.CareTask
+import com.gmg.growmygarden.reminder.ReminderScheduler
+import com.gmg.growmygarden.reminder.ReminderState
+import com.gmg.growmygarden.reminder.ReminderStore
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.flowOf
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.test.runCurrent
+import kotlinx.coroutines.test.runTest
+import kotlinx.datetime.LocalDateTime
+import kotlinx.datetime.TimeZone
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertTrue
+import kotlin.time.Clock
+import kotlin.time.Duration.Companion.days
+import kotlin.time.Duration.Companion.hours
+import kotlin.time.ExperimentalTime
+import kotlin.time.Instant
+import kotlin.uuid.Uuid
+
+class ReminderSchedulerTest {
+    private class FakeNotificationHandler : NotificationHandler {
+        val pending = mutableMapOf<String, String>()
+        val setIds = mutableListOf<String>()
+        val cancelledIds = mutableListOf<String>()
+
+        override fun setNotification(id: String, title: String, body: String, date: LocalDateTime, image: String?, delay: Long) {
+            setOneTimeNotification(id, title, body, date)
+        }
+
+        override fun setOneTimeNotification(id: String, title: String, body: String, date: LocalDateTime) {
+            pending[id] = title
+            setIds += id
+        }
+
+        override fun cancelNotification(id: String) {
+            pending.remove(id)
+            cancelledIds += id
+        }
+
+        override fun cancelAllNotifications() {
+            pending.clear()
+        }
+
+        fun resetCalls() {
+            setIds.clear()
+            cancelledIds.clear()
+        }
+    }
+
+    private class MemoryReminderStore : ReminderStore {
+        var state = ReminderState()
+
+        override suspend fun load(): ReminderState = state
+
+        override suspend fun save(state: ReminderState) {
+            this.state = state
+        }
+    }
+
+    private var now = Instant.fromEpochMilliseconds(0)
+    private val clock = object : Clock {
+        override fun now(): Instant = now
+    }
+
+    private val handler = FakeNotificationHandler()
+    private val scheduler = ReminderScheduler(handler, clock, TimeZone.UTC, maxNotifications = MAX_NOTIFICATIONS)
+
+    private fun garden(count: Int) = List(count) { index ->
+        Plant(
+            name = "Plant$index",
+            wateringFrequency = 1.days,
+            wateringNotificationID = Uuid.random(),
+            fertilizingFrequency = 7.days,
+            fertilizerNotificationID = Uuid.random(),
+            trimmingFrequency = 30.days,
+            trimmingNotificationID = Uuid.random(),
+        )
+    }
+
+    @Test
+    fun testLargeGardenStaysWithinLimit() = runTest {
+        scheduler.sync(garden(PLANT_COUNT))
+
+        assertEquals(MAX_NOTIFICATIONS, handler.pending.size, "Pending notifications not bounded")
+        val first = scheduler.scheduledDigests.first()
+        assertEquals(1.days, first.time - now)
+        assertEquals(PLANT_COUNT, first.events.size, "Same window not merged into one digest")
+        assertEquals(
+            PLANT_COUNT * 2,
+            scheduler.scheduledDigests.single { it.time - now == 7.days }.events.size,
+            "Watering and fertilizing due together not merged",
+        )
+    }
+
+    @Test
+    fun testUnchangedDigestsNotRescheduled() = runTest {
+        scheduler.sync(garden(PLANT_COUNT))
+        now += 3.hours
+        val rose = Plant(name = "Rose", trimmingFrequency = 2.days, trimmingNotificationID = Uuid.random())
+        scheduler.update(rose)
+        val roseDigests = scheduler.scheduledDigests.filter { digest -> digest.events.any { it.plantId == rose.uuid } }.map { it.id }.toSet()
+        val registered = handler.pending.keys.toSet()
+        handler.resetCalls()
+
+        scheduler.update(rose.copy(notes = "Edited"))
+        assertTrue(handler.setIds.isEmpty() && handler.cancelledIds.isEmpty(), "Edit without schedule change touched notifications")
+
+        scheduler.remove(rose.uuid)
+        assertTrue(roseDigests.isNotEmpty())
+        assertEquals(roseDigests, handler.cancelledIds.toSet(), "Digests without the removed plant were cancelled")
+        assertTrue(handler.setIds.none { it in registered }, "Unchanged digests were set again")
+        assertEquals(MAX_NOTIFICATIONS, handler.pending.size)
+    }
+
+    @Test
+    fun testRefreshMovesPastDigests() = runTest {
+        scheduler.sync(garden(1))
+        val first = scheduler.scheduledDigests.first()
+
+        now = first.time + 1.hours
+        scheduler.refresh()
+
+        assertTrue(scheduler.scheduledDigests.none { it.time <= now }, "Past digest still scheduled")
+        assertTrue(first.id !in handler.cancelledIds, "Fired digest was cancelled")
+        assertEquals(MAX_NOTIFICATIONS, scheduler.scheduledDigests.size)
+    }
+
+    @Test
+    fun testMarkDoneRestartsSeries() = runTest {
+        val plant = Plant(name = "Fern", wateringFrequency = 3.days, wateringNotificationID = Uuid.random())
+        scheduler.sync(listOf(plant))
+
+        now += 1.days
+        scheduler.markDone(plant.uuid, CareTask.WATER)
+        assertEquals(now + 3.days, scheduler.scheduledDigests.first().time)
+    }
+
+    @Test
+    fun testDisabledTaskNotScheduled() = runTest {
+        val plant = Plant(
+            name = "Basil",
+            wateringFrequency = 2.days,
+            wateringNotificationID = Uuid.random(),
+            fertilizingFrequency = 3.days,
+        )
+        scheduler.sync(listOf(plant))
+
+        val tasks = scheduler.scheduledDigests.flatMap { digest -> digest.events.map { it.task } }.toSet()
+        assertEquals(setOf(CareTask.WATER), tasks, "Task without a notification id was scheduled")
+
+        scheduler.update(plant.copy(wateringNotificationID = null))
+        assertTrue(scheduler.scheduledDigests.isEmpty(), "Disabling the reminder kept its digests")
+    }
+
+    @Test
+    fun testStartAtUsedWhenPlantSaved() = runTest {
+        val plant = Plant(name = "Mint", wateringFrequency = 2.days, wateringNotificationID = Uuid.random())
+        scheduler.startAt(plant.uuid, CareTask.WATER, now + 5.days)
+        scheduler.sync(listOf(plant))
+
+        assertEquals(now + 5.days, scheduler.scheduledDigests.first().time)
+    }
+
+    @Test
+    fun testRestartContinuesSchedule() = runTest {
+        val store = MemoryReminderStore()
+        val plants = garden(1)
+        val first = ReminderScheduler(handler, clock, TimeZone.UTC, maxNotifications = MAX_NOTIFICATIONS, store = store)
+        first.sync(plants)
+        val (fired, upcoming) = first.scheduledDigests.partition { it.time <= now + 1.days + 3.hours }
+
+        now += 1.days + 3.hours
+        val restarted = ReminderScheduler(handler, clock, TimeZone.UTC, maxNotifications = MAX_NOTIFICATIONS, store = store)
+        restarted.sync(plants)
+
+        assertEquals(now + 21.hours, restarted.scheduledDigests.first().time, "Series restarted from the launch time")
+        assertTrue(upcoming.all { it.id in handler.cancelledIds }, "Digests of the previous run left registered")
+        assertTrue(fired.none { it.id in handler.cancelledIds }, "Fired digest was cancelled")
+        assertEquals(MAX_NOTIFICATIONS, restarted.scheduledDigests.size)
+    }
+
+    @Test
+    fun testFollowAppliesDelta() = runTest {
+        val (kept, removed) = garden(2)
+        scheduler.follow(
+            flowOf(
+                ListUpdate(listOf(kept, removed), ListDelta(inserted = listOf(0, 1))),
+                ListUpdate(listOf(kept), ListDelta(removed = listOf(1))),
+            ),
+        )
+
+        assertEquals(setOf(kept.uuid), scheduledPlantIds())
+    }
+
+    @Test
+    fun testFollowSwitchesUser() = runTest {
+        val gardens = mapOf("alice" to garden(1), "bob" to garden(2))
+        val userIds = MutableStateFlow<String?>("alice")
+        val following = launch {
+            scheduler.follow(userIds) { userId ->
+                val plants = gardens[userId].orEmpty()
+                flowOf(ListUpdate(plants, ListDelta(inserted = plants.indices.toList())))
+            }
+        }
+
+        runCurrent()
+        assertEquals(gardens.getValue("alice").map { it.uuid }.toSet(), scheduledPlantIds())
+
+        userIds.value = "bob"
+        runCurrent()
+        assertEquals(gardens.getValue("bob").map { it.uuid }.toSet(), scheduledPlantIds(), "Previous user's plants still scheduled")
+
+        userIds.value = null
+        runCurrent()
+        assertTrue(scheduler.scheduledDigests.isEmpty(), "Plants scheduled after logout")
+        following.cancel()
+    }
+
+    private fun scheduledPlantIds() = scheduler.scheduledDigests.flatMap { digest -> digest.events.map { it.plantId } }.toSet()
+
+    companion object {
+        const val PLANT_COUNT = 100
+        const val MAX_NOTIFICATIONS = 48
+    }
+}
@@ -0,0 +1,9 @@
+package com.gmg.growmygarden
+
+import io.github.vinceglb.filekit.PlatformFile
+
+/**
+ * Expects a directory in each platform test source set that tests
+ * can write scratch files to
+ */
+expect fun testCacheDir(): PlatformFile
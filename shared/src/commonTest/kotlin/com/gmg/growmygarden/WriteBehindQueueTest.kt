@@ -0,0 +1,81 @@
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden
+
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.db.WriteBehindQueue
+import kotbase.MutableDocument
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.test.StandardTestDispatcher
+import kotlinx.coroutines.test.runTest
+import kotlin.test.AfterTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFailsWith
+import kotlin.test.assertNotNull
+import kotlin.test.assertNull
+
+@ExperimentalCoroutinesApi
+class WriteBehindQueueTest {
+    val dispatcher = StandardTestDispatcher()
+
+    private val dbProvider = DatabaseProvider(dispatcher = dispatcher)
+    private val collection by lazy {
+        dbProvider.database.getCollection(COLLECTION_NAME) ?: dbProvider.database.createCollection(COLLECTION_NAME)
+    }
+
+    private val failuresLeft = mutableMapOf<String, Int>()
+    private val dropped = mutableListOf<String>()
+
+    private val writeQueue = WriteBehindQueue<String, String>(
+        dbProvider = dbProvider,
+        write = { key, value ->
+            val left = failuresLeft[key] ?: 0
+            if (left > 0) {
+                failuresLeft[key] = left - 1
+                error("Write of $key failed")
+            }
+            collection.save(MutableDocument(key).setString(VALUE_KEY, value))
+        },
+        purge = { key -> collection.getDocument(key)?.let { doc -> collection.purge(doc) } },
+        onWriteFailed = { key, _ -> dropped += key },
+    )
+
+    @AfterTest
+    fun cleanup() {
+        listOf("good1", "bad", "good2", "flaky").forEach { id -> collection.getDocument(id)?.let { doc -> collection.purge(doc) } }
+    }
+
+    @Test
+    fun testFailedWriteKeepsOtherKeys() = runTest(dispatcher) {
+        failuresLeft["bad"] = Int.MAX_VALUE
+        writeQueue.put("good1", "1")
+        writeQueue.put("bad", "2")
+        writeQueue.put("good2", "3")
+
+        assertFailsWith<IllegalStateException> { writeQueue.flush() }
+        assertNotNull(collection.getDocument("good1"), "Write in the same batch as a failure was lost")
+        assertNotNull(collection.getDocument("good2"), "Write in the same batch as a failure was lost")
+        assertNull(collection.getDocument("bad"))
+        assertEquals(listOf("bad"), dropped)
+        assertEquals(0L, dbProvider.metrics.snapshot().queueDepth, "Dropped write still counted as queued")
+
+        // The error was reported once, later flushes succeed
+        writeQueue.flush()
+    }
+
+    @Test
+    fun testTransientFailureRetried() = runTest(dispatcher) {
+        failuresLeft["flaky"] = WriteBehindQueue.DEFAULT_MAX_ATTEMPTS - 1
+        writeQueue.put("flaky", "value")
+        writeQueue.flush()
+
+        assertEquals("value", collection.getDocument("flaky")?.getString(VALUE_KEY))
+        assertEquals(emptyList<String>(), dropped)
+    }
+
+    companion object {
+        const val COLLECTION_NAME = "writeQueueTest"
+        const val VALUE_KEY = "value"
+    }
+}
@@ -2,9 +2,75 @@ package com.gmg.growmygarden
 
 import com.tweener.alarmee.configuration.AlarmeeIosPlatformConfiguration
 import com.tweener.alarmee.configuration.AlarmeePlatformConfiguration
+import com.tweener.alarmee.createAlarmeeService
+import com.tweener.alarmee.model.Alarmee
+import com.tweener.alarmee.model.AndroidNotificationConfiguration
+import com.tweener.alarmee.model.AndroidNotificationPriority
+import com.tweener.alarmee.model.IosNotificationConfiguration
+import com.tweener.alarmee.model.RepeatInterval
+import kotlinx.datetime.LocalDateTime
+import kotlin.time.Duration.Companion.minutes
+
+/**
+ * [NotificationHandler] that uses the Alarmee library
+ */
+class AlarmeeNotificationHandler : NotificationHandler {
+    private val alarmeeService = createAlarmeeService().apply {
+        initialize(createAlarmeePlatformConfiguration())
+    }
+
+    private val localService = alarmeeService.local
+
+    override fun setNotification(id: String, title: String, body: String, date: LocalDateTime, image: String?, delay: Long) {
+        localService.schedule(
+            alarmee = Alarmee(
+                uuid = id,
+                notificationTitle = title,
+                notificationBody = body,
+                scheduledDateTime = date,
+                imageUrl = image,
+                repeatInterval = RepeatInterval.Custom(duration = delay.minutes),
+                androidNotificationConfiguration = AndroidNotificationConfiguration(
+                    priority = AndroidNotificationPriority.HIGH,
+                    channelId = "dailyNewsChannelId",
+                ),
+                iosNotificationConfiguration = IosNotificationConfiguration(),
+            ),
+        )
+    }
+
+    override fun setOneTimeNotification(id: String, title: String, body: String, date: LocalDateTime) {
+        localService.schedule(
+            alarmee = Alarmee(
+                uuid = id,
+                notificationTitle = title,
+                notificationBody = body,
+                scheduledDateTime = date,
+                androidNotificationConfiguration = AndroidNotificationConfiguration(
+                    priority = AndroidNotificationPriority.HIGH,
+                    channelId = "dailyNewsChannelId",
+                ),
+                iosNotificationConfiguration = IosNotificationConfiguration(),
+            ),
+        )
+    }
+
+    override fun cancelNotification(id: String) {
+        localService.cancel(uuid = id)
+    }
+
+    override fun cancelAllNotifications() {
+        localService.cancelAll()
+    }
+}
 
 /**
  * Function that configure Alarmee on ios platforms
  */
-internal actual fun createAlarmeePlatformConfiguration(): AlarmeePlatformConfiguration =
+internal fun createAlarmeePlatformConfiguration(): AlarmeePlatformConfiguration =
     AlarmeeIosPlatformConfiguration
+
+/**
+ * Notifications are scheduled through Alarmee on ios
+ */
+internal actual fun createNotificationHandler(): NotificationHandler = AlarmeeNotificationHandler()
@@ -0,0 +1,6 @@
+package com.gmg.growmygarden.data.db
+
+/**
+ * The CouchbaseLite framework needs no setup on ios
+ */
+internal actual fun initDatabasePlatform() = Unit
@@ -5,9 +5,12 @@ import kotlinx.datetime.Month
 import kotlin.test.AfterTest
 import kotlin.test.Test
 
-class NotificationTest(
-    private val notificationHandler: NotificationHandler,
-) {
+/**
+ * Schedules through the platform notification handler, only on iOS where
+ * there is one
+ */
+class NotificationTest {
+    private val notificationHandler: NotificationHandler = createNotificationHandler()
 
     @AfterTest
     fun cleanup() {
@@ -0,0 +1,7 @@
+package com.gmg.growmygarden
+
+import io.github.vinceglb.filekit.FileKit
+import io.github.vinceglb.filekit.PlatformFile
+import io.github.vinceglb.filekit.cacheDir
+
+actual fun testCacheDir(): PlatformFile = FileKit.cacheDir
@@ -0,0 +1,70 @@
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden.benchmark
+
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.source.Plant
+import com.gmg.growmygarden.data.source.PlantInfo
+import kotlinx.coroutines.cancel
+import kotlin.time.Duration.Companion.days
+import kotlin.uuid.Uuid
+
+/**
+ * Generated datasets and database handling shared by the benchmarks
+ */
+internal object BenchmarkData {
+    const val USER_ID = "benchmark-user"
+
+    private val adjectives = listOf("Golden", "Dwarf", "Creeping", "Giant", "Silver", "Scarlet", "Weeping", "Wild")
+    private val nouns = listOf("Fern", "Ivy", "Maple", "Rose", "Tomato", "Basil", "Orchid", "Cactus")
+    private val families = listOf("Aspleniaceae", "Araliaceae", "Sapindaceae", "Rosaceae", "Solanaceae", "Lamiaceae")
+
+    /**
+     * Prefix queries over every adjective and noun pair. There are more of
+     * them than the repository caches, so cycling through them always runs
+     * the query.
+     */
+    val searchQueries: List<String> = adjectives.flatMap { adjective ->
+        nouns.map { noun -> "${adjective.take(3)} ${noun.take(3)}" }
+    }
+
+    private fun commonName(index: Int) = "${adjectives[index % adjectives.size]} ${nouns[index / adjectives.size % nouns.size]} $index"
+
+    fun plants(count: Int): List<Plant> = List(count) { index ->
+        Plant(
+            name = commonName(index),
+            species = nouns[index % nouns.size],
+            wateringFrequency = (1 + index % 7).days,
+            fertilizingFrequency = (7 + index % 21).days,
+            trimmingFrequency = if (index % 3 == 0) 30.days else 0.days,
+            notes = "Generated plant $index",
+        )
+    }
+
+    fun plantInfo(count: Int): List<PlantInfo> = List(count) { index ->
+        PlantInfo(
+            id = index,
+            name = commonName(index),
+            scientificName = listOf("${nouns[index % nouns.size]}us ${adjectives[index % adjectives.size].lowercase()}ii"),
+            family = families[index % families.size],
+            watering = "Average",
+            sunExposure = listOf("full sun", "part shade"),
+        )
+    }
+
+    /**
+     * Provider for a database only this benchmark run uses
+     */
+    fun openDatabase(prefix: String): DatabaseProvider {
+        return DatabaseProvider(name = "benchmark-$prefix-${Uuid.random().toHexString()}")
+    }
+
+    /**
+     * Prints what the run did to the database and deletes it
+     */
+    fun closeDatabase(label: String, dbProvider: DatabaseProvider) {
+        println("$label: ${dbProvider.metrics.snapshot()}")
+        dbProvider.scope.cancel()
+        dbProvider.database.delete()
+    }
+}
@@ -0,0 +1,91 @@
+@file:OptIn(ExperimentalEncodingApi::class)
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden.benchmark
+
+import com.gmg.growmygarden.data.db.DocumentCodec
+import com.gmg.growmygarden.data.source.PlantDoc
+import kotbase.MutableDocument
+import kotlinx.benchmark.Benchmark
+import kotlinx.benchmark.Param
+import kotlinx.benchmark.Scope
+import kotlinx.benchmark.Setup
+import kotlinx.benchmark.State
+import kotlinx.serialization.json.Json
+import kotlin.io.encoding.Base64
+import kotlin.io.encoding.ExperimentalEncodingApi
+import kotlin.random.Random
+
+/**
+ * Converting [size] plant documents to and from kotbase documents, through
+ * a JSON string as the repositories used to and through [DocumentCodec]
+ */
+@State(Scope.Benchmark)
+class DocumentCodecBenchmark {
+    @Param("100", "10000", "100000")
+    var size = 0
+
+    private lateinit var plantDocs: List<PlantDoc>
+    private lateinit var jsonStrings: List<String>
+    private lateinit var documents: List<MutableDocument>
+    private lateinit var inlineImageDocuments: List<MutableDocument>
+
+    @Setup
+    fun setup() {
+        plantDocs = BenchmarkData.plants(size).map { plant ->
+            PlantDoc(
+                uuid = plant.uuid,
+                userId = BenchmarkData.USER_ID,
+                name = plant.name,
+                species = plant.species,
+                wateringFrequency = plant.wateringFrequency,
+                fertilizingFrequency = plant.fertilizingFrequency,
+                trimmingFrequency = plant.trimmingFrequency,
+                notes = plant.notes,
+            )
+        }
+        jsonStrings = plantDocs.map { Json.encodeToString(it) }
+        documents = codecEncode()
+
+        // Photos stored inline as "uuid|base64" before they moved to blobs
+        val random = Random(size)
+        inlineImageDocuments = plantDocs.map { doc ->
+            MutableDocument(doc.uuid.toHexDashString()).also { document ->
+                DocumentCodec.encode(doc, document)
+                document.setString(IMAGE_KEY, "${doc.uuid.toHexDashString()}|${Base64.encode(random.nextBytes(IMAGE_BYTES))}")
+            }
+        }
+    }
+
+    @Benchmark
+    fun jsonEncode(): List<MutableDocument> = plantDocs.map { doc ->
+        MutableDocument(doc.uuid.toHexDashString(), Json.encodeToString(doc))
+    }
+
+    @Benchmark
+    fun jsonDecode(): List<PlantDoc> = jsonStrings.map { json -> Json.decodeFromString<PlantDoc>(json) }
+
+    @Benchmark
+    fun codecEncode(): List<MutableDocument> = plantDocs.map { doc ->
+        MutableDocument(doc.uuid.toHexDashString()).also { document -> DocumentCodec.encode(doc, document) }
+    }
+
+    @Benchmark
+    fun codecDecode(): List<PlantDoc> = documents.map { document -> DocumentCodec.decode<PlantDoc>(document) }
+
+    /**
+     * Decoding documents that still hold their photo inline, which is what
+     * the blob migration reads
+     */
+    @Benchmark
+    fun inlineImageDecode(): List<ByteArray?> = inlineImageDocuments.map { document ->
+        DocumentCodec.decode<PlantDoc>(document).image?.imageBytes
+    }
+
+    companion object {
+        private const val IMAGE_KEY = "image"
+
+        // Small enough that the 100k dataset fits in the default heap
+        private const val IMAGE_BYTES = 1024
+    }
+}
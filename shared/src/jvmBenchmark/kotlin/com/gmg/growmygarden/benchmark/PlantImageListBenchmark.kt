@@ -0,0 +1,88 @@
+@file:OptIn(ExperimentalEncodingApi::class)
+@file:Suppress("MISSING_DEPENDENCY_SUPERCLASS_IN_TYPE_ARGUMENT")
+
+package com.gmg.growmygarden.benchmark
+
+import com.gmg.growmygarden.auth.UserManager
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.db.DocumentCodec
+import com.gmg.growmygarden.data.source.Plant
+import com.gmg.growmygarden.data.source.PlantDoc
+import com.gmg.growmygarden.data.source.PlantRepository
+import kotbase.MutableDocument
+import kotlinx.benchmark.Benchmark
+import kotlinx.benchmark.Param
+import kotlinx.benchmark.Scope
+import kotlinx.benchmark.Setup
+import kotlinx.benchmark.State
+import kotlinx.benchmark.TearDown
+import kotlinx.coroutines.flow.first
+import kotlinx.coroutines.runBlocking
+import kotlin.io.encoding.Base64
+import kotlin.io.encoding.ExperimentalEncodingApi
+import kotlin.random.Random
+
+/**
+ * Loading the plants list when every one of [size] plants has a photo,
+ * stored inline as before the blob migration or as a blob. Run with the gc
+ * profiler of the main configuration, gc.alloc.rate.norm shows the memory
+ * each list load allocates.
+ */
+@State(Scope.Benchmark)
+class PlantImageListBenchmark {
+    @Param("100", "500", "1000")
+    var size = 0
+
+    @Param("inline", "blob")
+    var layout = ""
+
+    private lateinit var dbProvider: DatabaseProvider
+    private lateinit var repository: PlantRepository
+
+    @Setup
+    fun setup() {
+        dbProvider = BenchmarkData.openDatabase("images")
+        val database = dbProvider.database
+
+        // Mark the migration as done so the repository keeps the inline photos
+        val metadata = database.getCollection(PlantRepository.METADATA_COLLECTION_NAME)
+            ?: database.createCollection(PlantRepository.METADATA_COLLECTION_NAME)
+        metadata.save(MutableDocument(PlantRepository.INLINE_IMAGE_MIGRATION_ID))
+
+        repository = PlantRepository(dbProvider, UserManager().apply { login(BenchmarkData.USER_ID) })
+        val random = Random(size)
+        database.inBatch {
+            for (plant in BenchmarkData.plants(size)) {
+                val doc = PlantDoc(uuid = plant.uuid, userId = BenchmarkData.USER_ID, name = plant.name, species = plant.species)
+                val document = MutableDocument(doc.uuid.toHexDashString())
+                DocumentCodec.encode(doc, document)
+                document.setString(IMAGE_KEY, "${doc.uuid.toHexDashString()}|${Base64.encode(random.nextBytes(IMAGE_BYTES))}")
+                repository.collection.save(document)
+            }
+        }
+        if (layout == "blob") {
+            runBlocking { repository.migrateInlineImages() }
+        }
+        dbProvider.metrics.reset()
+    }
+
+    @TearDown
+    fun tearDown() {
+        BenchmarkData.closeDatabase("PlantImageListBenchmark[size=$size, layout=$layout]", dbProvider)
+    }
+
+    /**
+     * A fresh query each time, so the list is read from the database
+     */
+    @Benchmark
+    fun listQuery(): List<Plant> = runBlocking {
+        repository.livePlants(BenchmarkData.USER_ID).asFlow().first().items
+    }
+
+    companion object {
+        private const val IMAGE_KEY = "image"
+
+        // A downscaled camera photo
+        private const val IMAGE_BYTES = 32 * 1024
+    }
+}
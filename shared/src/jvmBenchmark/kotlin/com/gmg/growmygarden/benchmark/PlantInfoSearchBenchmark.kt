@@ -0,0 +1,48 @@
+package com.gmg.growmygarden.benchmark
+
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.source.PlantInfo
+import com.gmg.growmygarden.data.source.PlantInfoRepository
+import com.gmg.growmygarden.network.PerenualApi
+import com.gmg.growmygarden.network.createHttpClient
+import kotlinx.benchmark.Benchmark
+import kotlinx.benchmark.Param
+import kotlinx.benchmark.Scope
+import kotlinx.benchmark.Setup
+import kotlinx.benchmark.State
+import kotlinx.benchmark.TearDown
+import kotlinx.coroutines.runBlocking
+
+/**
+ * Local full text search over [size] stored PlantInfo documents
+ */
+@State(Scope.Benchmark)
+class PlantInfoSearchBenchmark {
+    @Param("100", "10000", "100000")
+    var size = 0
+
+    private lateinit var dbProvider: DatabaseProvider
+    private lateinit var repository: PlantInfoRepository
+    private var next = 0
+
+    @Setup
+    fun setup() {
+        dbProvider = BenchmarkData.openDatabase("search")
+        // Never called, searchPlantInfo only reads the local database
+        val api = PerenualApi(createHttpClient("benchmark"), "benchmark")
+        repository = PlantInfoRepository(dbProvider, api)
+        runBlocking { repository.saveMultiplePlantInfo(*BenchmarkData.plantInfo(size).toTypedArray()) }
+        dbProvider.metrics.reset()
+    }
+
+    @TearDown
+    fun tearDown() {
+        BenchmarkData.closeDatabase("PlantInfoSearchBenchmark[size=$size]", dbProvider)
+    }
+
+    @Benchmark
+    fun searchPlantInfo(): List<PlantInfo> = runBlocking {
+        val queries = BenchmarkData.searchQueries
+        repository.searchPlantInfo(queries[next++ % queries.size])
+    }
+}
@@ -0,0 +1,70 @@
+package com.gmg.growmygarden.benchmark
+
+import com.gmg.growmygarden.auth.UserManager
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.source.Plant
+import com.gmg.growmygarden.data.source.PlantRepository
+import kotlinx.benchmark.Benchmark
+import kotlinx.benchmark.Param
+import kotlinx.benchmark.Scope
+import kotlinx.benchmark.Setup
+import kotlinx.benchmark.State
+import kotlinx.benchmark.TearDown
+import kotlinx.coroutines.flow.first
+import kotlinx.coroutines.runBlocking
+
+/**
+ * Writes and reads through [PlantRepository] on a database holding [size]
+ * plants of one user
+ */
+@State(Scope.Benchmark)
+class PlantRepositoryBenchmark {
+    @Param("100", "10000", "100000")
+    var size = 0
+
+    private lateinit var dbProvider: DatabaseProvider
+    private lateinit var repository: PlantRepository
+    private lateinit var plants: List<Plant>
+    private var next = 0
+    private var edits = 0
+
+    @Setup
+    fun setup() {
+        dbProvider = BenchmarkData.openDatabase("plants")
+        repository = PlantRepository(dbProvider, UserManager().apply { login(BenchmarkData.USER_ID) })
+        plants = BenchmarkData.plants(size)
+        runBlocking { repository.savePlants(plants) }
+        dbProvider.metrics.reset()
+    }
+
+    @TearDown
+    fun tearDown() {
+        BenchmarkData.closeDatabase("PlantRepositoryBenchmark[size=$size]", dbProvider)
+    }
+
+    private fun nextPlant(): Plant = plants[next++ % plants.size]
+
+    /**
+     * Edits of up to [BULK_SIZE] plants saved together, so larger datasets
+     * measure the cost of a batch against a bigger collection
+     */
+    @Benchmark
+    fun savePlantsBulk() = runBlocking {
+        edits++
+        repository.savePlants(List(minOf(size, BULK_SIZE)) { nextPlant().copy(notes = "Edit $edits") })
+    }
+
+    @Benchmark
+    fun plantsFirstEmission(): List<Plant> = runBlocking {
+        repository.plants.first()
+    }
+
+    @Benchmark
+    fun getPlant(): Plant? = runBlocking {
+        repository.getPlant(nextPlant().uuid)
+    }
+
+    companion object {
+        const val BULK_SIZE = 1000
+    }
+}
@@ -0,0 +1,70 @@
+package com.gmg.growmygarden.benchmark
+
+import com.gmg.growmygarden.auth.UserManager
+import com.gmg.growmygarden.data.db.DatabaseProvider
+import com.gmg.growmygarden.data.db.ListUpdate
+import com.gmg.growmygarden.data.source.Plant
+import com.gmg.growmygarden.data.source.PlantRepository
+import kotlinx.benchmark.Benchmark
+import kotlinx.benchmark.Param
+import kotlinx.benchmark.Scope
+import kotlinx.benchmark.Setup
+import kotlinx.benchmark.State
+import kotlinx.benchmark.TearDown
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.cancel
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.runBlocking
+
+/**
+ * Time from saving an edited plant until a collector of
+ * [PlantRepository.plantUpdates] receives the change, with [size] plants
+ * in the collection
+ */
+@State(Scope.Benchmark)
+class PlantUpdateBenchmark {
+    @Param("100", "10000", "100000")
+    var size = 0
+
+    private lateinit var dbProvider: DatabaseProvider
+    private lateinit var repository: PlantRepository
+    private lateinit var plants: List<Plant>
+    private val collectorScope = CoroutineScope(Dispatchers.Default + Job())
+    private val updates = Channel<ListUpdate<Plant>>(Channel.UNLIMITED)
+    private var edits = 0
+
+    @Setup
+    fun setup() {
+        dbProvider = BenchmarkData.openDatabase("updates")
+        repository = PlantRepository(dbProvider, UserManager().apply { login(BenchmarkData.USER_ID) })
+        plants = BenchmarkData.plants(size)
+        runBlocking {
+            repository.savePlants(plants)
+            collectorScope.launch { repository.plantUpdates.collect(updates::send) }
+            updates.receive()
+        }
+        dbProvider.metrics.reset()
+    }
+
+    @TearDown
+    fun tearDown() {
+        collectorScope.cancel()
+        BenchmarkData.closeDatabase("PlantUpdateBenchmark[size=$size]", dbProvider)
+    }
+
+    @Benchmark
+    fun plantUpdateLatency(): ListUpdate<Plant> = runBlocking {
+        edits++
+        val edited = plants[edits % plants.size].copy(notes = "Edit $edits")
+        // Flushes right away instead of waiting for the write queue's batch delay
+        repository.savePlants(listOf(edited))
+        var update = updates.receive()
+        while (update.delta.updated.none { index -> update.items[index].uuid == edited.uuid }) {
+            update = updates.receive()
+        }
+        update
+    }
+}
@@ -0,0 +1,19 @@
+package com.gmg.growmygarden
+
+import kotlinx.datetime.LocalDateTime
+
+/**
+ * The JVM target only runs tests and benchmarks, which have no
+ * notification center to post to
+ */
+private object NoOpNotificationHandler : NotificationHandler {
+    override fun setNotification(id: String, title: String, body: String, date: LocalDateTime, image: String?, delay: Long) = Unit
+
+    override fun setOneTimeNotification(id: String, title: String, body: String, date: LocalDateTime) = Unit
+
+    override fun cancelNotification(id: String) = Unit
+
+    override fun cancelAllNotifications() = Unit
+}
+
+internal actual fun createNotificationHandler(): NotificationHandler = NoOpNotificationHandler
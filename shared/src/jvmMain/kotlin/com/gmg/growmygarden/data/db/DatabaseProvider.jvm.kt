@@ -0,0 +1,11 @@
+package com.gmg.growmygarden.data.db
+
+import com.couchbase.lite.CouchbaseLite
+
+// CouchbaseLite.init loads the native library, once per process
+private val couchbaseLite: Unit by lazy { CouchbaseLite.init() }
+
+/**
+ * Loads the Couchbase Lite native library on the JVM
+ */
+internal actual fun initDatabasePlatform() = couchbaseLite
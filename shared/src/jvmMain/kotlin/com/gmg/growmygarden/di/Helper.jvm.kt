@@ -0,0 +1,14 @@
+package com.gmg.growmygarden.di
+
+import java.util.Properties
+
+/**
+ * Reads Secrets.properties from the classpath, the JVM counterpart of the
+ * Secrets.plist bundled with the ios app
+ */
+actual fun getPropertiesMap(): Map<String, Any> {
+    val stream = Thread.currentThread().contextClassLoader?.getResourceAsStream("Secrets.properties")
+        ?: return emptyMap()
+    val properties = stream.use { Properties().apply { load(it) } }
+    return properties.stringPropertyNames().associateWith { key -> properties.getProperty(key) }
+}
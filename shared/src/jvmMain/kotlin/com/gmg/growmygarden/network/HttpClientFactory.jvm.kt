@@ -0,0 +1,27 @@
+package com.gmg.growmygarden.network
+
+import io.ktor.client.HttpClient
+import io.ktor.client.engine.okhttp.OkHttp
+import io.ktor.client.plugins.contentnegotiation.ContentNegotiation
+import io.ktor.client.plugins.defaultRequest
+import io.ktor.http.URLProtocol
+import io.ktor.http.appendPathSegments
+import io.ktor.serialization.kotlinx.json.json
+import kotlinx.serialization.json.Json
+
+/**
+ * Creates the jvm version of the HttpClient for doing API requests
+ */
+actual fun createHttpClient(perenualKey: String): HttpClient = HttpClient(OkHttp) {
+    install(ContentNegotiation) {
+        json(Json { ignoreUnknownKeys = true })
+    }
+    defaultRequest {
+        url {
+            protocol = URLProtocol.HTTPS
+            host = "perenual.com"
+            appendPathSegments("api", "v2")
+            parameters.append("key", perenualKey)
+        }
+    }
+}
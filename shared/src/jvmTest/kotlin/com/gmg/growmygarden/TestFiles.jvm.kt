@@ -0,0 +1,9 @@
+package com.gmg.growmygarden
+
+import io.github.vinceglb.filekit.PlatformFile
+
+/**
+ * FileKit needs an app id for its directories on the JVM, the system
+ * temp directory is used instead
+ */
+actual fun testCacheDir(): PlatformFile = PlatformFile(System.getProperty("java.io.tmpdir"))